@@ -0,0 +1,240 @@
+#pragma once
+
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hash128.hpp"
+#include "json.hpp"
+
+// ======================= ANALYSIS CACHE ========================
+// Caché de respuestas de la IA. La clave es un hash del problema, del código
+// normalizado (sin comentarios ni espacios sobrantes) y del vector de
+// resultados por caso, así que reenviar el mismo código (o la plantilla sin
+// tocar) no vuelve a gastar una llamada. LRU acotada en memoria y, si hay
+// `dir`, un fichero JSON por entrada que sobrevive a reinicios. Las entradas
+// caducan tras `ttl` en ambos niveles.
+class AnalysisCache {
+public:
+    struct Config {
+        size_t maxEntries = 1024;            // en memoria
+        size_t maxDiskEntries = 10000;
+        std::chrono::seconds ttl{ 86400 };
+        std::filesystem::path dir;           // vacío = solo memoria
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t diskHits = 0;    // incluidos en hits
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t diskEntries = 0;
+    };
+
+    using Lines = std::vector<std::string>;
+
+    void open(const Config& cfg) {
+        std::lock_guard<std::mutex> lk(m_);
+        cfg_ = cfg;
+        if (cfg_.dir.empty()) return;
+        std::error_code ec;
+        std::filesystem::create_directories(cfg_.dir, ec);
+        for (const auto& e : std::filesystem::directory_iterator(cfg_.dir, ec)) {
+            if (e.path().extension() != ".json") continue;
+            std::ifstream f(e.path(), std::ios::binary);
+            auto j = nlohmann::json::parse(f, nullptr, false);
+            if (!j.is_object()) continue;
+            disk_[e.path().stem().string()] = j.value("createdAt", (int64_t)0);
+        }
+        evict_disk_locked();
+    }
+
+    // Clave de caché: problema + código normalizado + resultado de cada caso
+    static std::string make_key(const std::string& problemId, const std::string& source,
+        const nlohmann::json& results) {
+        std::string outcome;
+        if (results.is_object() && results.contains("results") && results["results"].is_array()) {
+            for (const auto& r : results["results"]) {
+                if (!r.is_object()) continue;
+                if (r.value("pass", false)) outcome += 'P';
+                else if (r.value("skipped", false)) outcome += 'S';
+                else outcome += r.value("verdict", std::string("F"));
+                outcome += ',';
+            }
+        }
+        // 128 bits de clave (ver hash128.hpp)
+        return hash128::Hasher().part(problemId).part(normalize_source(source)).part(outcome).hex();
+    }
+
+    // Quita comentarios y reduce los espacios al mínimo que separa tokens;
+    // respeta literales de cadena y carácter
+    static std::string normalize_source(const std::string& src) {
+        auto ident = [](char c) { return std::isalnum((unsigned char)c) || c == '_'; };
+        std::string out;
+        out.reserve(src.size());
+        bool pendingSpace = false;
+        size_t i = 0, n = src.size();
+        while (i < n) {
+            char c = src[i];
+            if (c == '/' && i + 1 < n && src[i + 1] == '/') {
+                while (i < n && src[i] != '\n') ++i;
+                pendingSpace = true;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && src[i + 1] == '*') {
+                size_t end = src.find("*/", i + 2);
+                i = end == std::string::npos ? n : end + 2;
+                pendingSpace = true;
+                continue;
+            }
+            if (std::isspace((unsigned char)c)) {
+                pendingSpace = true;
+                ++i;
+                continue;
+            }
+            if (pendingSpace && !out.empty() && ident(out.back()) && ident(c)) out += ' ';
+            pendingSpace = false;
+            if (c == '"' || c == '\'') {
+                char q = c;
+                out += src[i++];
+                while (i < n && src[i] != q) {
+                    if (src[i] == '\\' && i + 1 < n) out += src[i++];
+                    out += src[i++];
+                }
+                if (i < n) out += src[i++];
+                continue;
+            }
+            out += c;
+            ++i;
+        }
+        return out;
+    }
+
+    std::optional<Lines> get(const std::string& key) {
+        std::lock_guard<std::mutex> lk(m_);
+        const int64_t now = now_s();
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            if (now - it->second.createdAt < (int64_t)cfg_.ttl.count()) {
+                lru_.splice(lru_.begin(), lru_, it->second.pos);
+                ++hits_;
+                return it->second.lines;
+            }
+            lru_.erase(it->second.pos);
+            map_.erase(it);
+        }
+
+        auto d = disk_.find(key);
+        if (d != disk_.end()) {
+            if (now - d->second < (int64_t)cfg_.ttl.count()) {
+                std::ifstream f(file_path(key), std::ios::binary);
+                auto j = nlohmann::json::parse(f, nullptr, false);
+                if (j.is_object() && j.contains("lines") && j["lines"].is_array()) {
+                    Lines lines = j["lines"].get<Lines>();
+                    insert_locked(key, lines, d->second);
+                    ++hits_;
+                    ++diskHits_;
+                    return lines;
+                }
+            }
+            remove_file_locked(key);
+        }
+        ++misses_;
+        return std::nullopt;
+    }
+
+    void put(const std::string& key, const Lines& lines) {
+        std::lock_guard<std::mutex> lk(m_);
+        const int64_t now = now_s();
+        insert_locked(key, lines, now);
+        if (cfg_.dir.empty()) return;
+
+        nlohmann::json j = { {"createdAt", now}, {"lines", lines} };
+        auto path = file_path(key);
+        auto tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            f << j.dump();
+            if (!f) return;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) return;
+        disk_[key] = now;
+        evict_disk_locked();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return Stats{ hits_, diskHits_, misses_, evictions_, map_.size(), disk_.size() };
+    }
+
+private:
+    struct Entry {
+        Lines lines;
+        int64_t createdAt = 0;
+        std::list<std::string>::iterator pos;
+    };
+
+    static int64_t now_s() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::filesystem::path file_path(const std::string& key) const { return cfg_.dir / (key + ".json"); }
+
+    void insert_locked(const std::string& key, const Lines& lines, int64_t createdAt) {
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            it->second.lines = lines;
+            it->second.createdAt = createdAt;
+            lru_.splice(lru_.begin(), lru_, it->second.pos);
+            return;
+        }
+        lru_.push_front(key);
+        map_[key] = Entry{ lines, createdAt, lru_.begin() };
+        while (map_.size() > cfg_.maxEntries && !lru_.empty()) {
+            map_.erase(lru_.back());
+            lru_.pop_back();
+            ++evictions_;
+        }
+    }
+
+    void remove_file_locked(const std::string& key) {
+        std::error_code ec;
+        std::filesystem::remove(file_path(key), ec);
+        disk_.erase(key);
+    }
+
+    // Borra primero los ficheros más antiguos
+    void evict_disk_locked() {
+        while (disk_.size() > cfg_.maxDiskEntries) {
+            auto oldest = disk_.begin();
+            for (auto it = disk_.begin(); it != disk_.end(); ++it) {
+                if (it->second < oldest->second) oldest = it;
+            }
+            remove_file_locked(oldest->first);
+        }
+    }
+
+    mutable std::mutex m_;
+    Config cfg_;
+    std::list<std::string> lru_;                         // más reciente al frente
+    std::unordered_map<std::string, Entry> map_;
+    std::unordered_map<std::string, int64_t> disk_;      // clave -> createdAt
+    uint64_t hits_ = 0;
+    uint64_t diskHits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
@@ -0,0 +1,626 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// ===================== COMPLEXITY ESTIMATOR ====================
+// Estimación estática de la complejidad a partir del código del estudiante.
+// Tokeniza el fuente (sin comentarios, literales ni preprocesador), sigue el
+// anidamiento de bucles, el costo de las operaciones sobre contenedores según
+// el tipo declarado de cada variable (find/erase en vector, map vs
+// unordered_map, sort...) y la forma de la recursión. No es un parser de C++:
+// son heurísticas baratas (microsegundos) que aciertan en el código típico de
+// ejercicios y permiten responder sin esperar a la IA.
+
+// Clase de complejidad n^poly · log^logs n (o exponencial)
+struct Complexity {
+    int poly = 0;
+    int logs = 0;
+    bool exp = false;
+
+    static Complexity constant() { return {}; }
+    static Complexity log_n() { return { 0, 1, false }; }
+    static Complexity linear() { return { 1, 0, false }; }
+    static Complexity n_log_n() { return { 1, 1, false }; }
+
+    Complexity operator*(const Complexity& o) const {
+        return { poly + o.poly, logs + o.logs, exp || o.exp };
+    }
+    bool operator<(const Complexity& o) const {
+        if (exp != o.exp) return !exp;
+        if (poly != o.poly) return poly < o.poly;
+        return logs < o.logs;
+    }
+    bool operator==(const Complexity& o) const {
+        return exp == o.exp && poly == o.poly && logs == o.logs;
+    }
+
+    std::string str() const {
+        if (exp) return "O(2^n)";
+        if (poly == 0 && logs == 0) return "O(1)";
+        std::string s = "O(";
+        if (poly == 1) s += "n";
+        else if (poly > 1) s += "n^" + std::to_string(poly);
+        if (logs > 0) {
+            if (poly > 0) s += " ";
+            s += logs == 1 ? "log n" : "log^" + std::to_string(logs) + " n";
+        }
+        return s + ")";
+    }
+
+    // Lee "O(1)", "O(log n)", "O(n)", "O(n log n)", "O(n^2)"... (admite texto detrás)
+    static std::optional<Complexity> parse(const std::string& text) {
+        auto open = text.find("O(");
+        auto close = text.find(')', open);
+        if (open == std::string::npos || close == std::string::npos) return std::nullopt;
+        std::string in = text.substr(open + 2, close - open - 2);
+        Complexity c;
+        if (in == "1") return c;
+        if (in.find("2^n") != std::string::npos) {
+            c.exp = true;
+            return c;
+        }
+        if (in.find("log") != std::string::npos) c.logs = 1;
+        auto n = in.find('n');
+        if (n != std::string::npos && in.compare(0, 3, "log") != 0) {
+            c.poly = 1;
+            if (n + 2 < in.size() && in[n + 1] == '^') c.poly = in[n + 2] - '0';
+        }
+        if (c.poly == 0 && c.logs == 0) return std::nullopt;
+        return c;
+    }
+};
+
+struct ComplexityReport {
+    bool analyzed = false;              // false si no había código que analizar
+    Complexity complexity;
+    std::vector<std::string> hints;     // pistas de rendimiento concretas (con línea)
+};
+
+class ComplexityEstimator {
+public:
+    static constexpr size_t MAX_HINTS = 6;
+
+    explicit ComplexityEstimator(const std::string& source) { tokenize(source); }
+
+    ComplexityReport run() {
+        ComplexityReport rep;
+        if (t_.empty()) return rep;
+        collect_declarations();
+        collect_functions();
+        rep.analyzed = true;
+
+        if (funcs_.empty()) {
+            record_ = true;
+            rep.complexity = analyze(0, t_.size(), Complexity::constant(), "");
+        }
+        else {
+            // Varias pasadas para propagar el costo de funciones auxiliares a
+            // quien las llama; las pistas se recogen solo en la última
+            for (int pass = 0; pass < 3; ++pass) {
+                record_ = pass == 2;
+                std::unordered_map<std::string, Complexity> next;
+                for (auto& f : funcs_) {
+                    f.cost = function_cost(f);
+                    next[f.name] = std::max(next[f.name], f.cost);   // sobrecargas: la peor
+                }
+                funcCost_ = std::move(next);
+            }
+            for (const auto& f : funcs_) rep.complexity = std::max(rep.complexity, f.cost);
+        }
+        rep.hints = std::move(hints_);
+        return rep;
+    }
+
+private:
+    enum class Kind { Ident, Number, Punct, Literal };
+    struct Token {
+        Kind kind;
+        std::string text;
+        int line;
+    };
+
+    enum class Container { Sequence, Ordered, Hashed, Heap, List };
+
+    struct Function {
+        std::string name;
+        int line = 0;
+        size_t bodyBegin = 0;   // índice del '{'
+        size_t bodyEnd = 0;     // índice del '}'
+        std::vector<std::string> byValue;   // contenedores recibidos por valor
+        Complexity cost;
+    };
+
+    // ---------------- tokenizer ----------------
+
+    void tokenize(const std::string& s) {
+        static const char* OPS2[] = { "::", "->", "++", "--", "+=", "-=", "*=", "/=", "%=",
+            "<=", ">=", "==", "!=", "&&", "||" };
+        int line = 1;
+        bool lineStart = true;
+        size_t i = 0, n = s.size();
+        while (i < n) {
+            char c = s[i];
+            if (c == '\n') {
+                ++line;
+                lineStart = true;
+                ++i;
+                continue;
+            }
+            if (std::isspace((unsigned char)c)) {
+                ++i;
+                continue;
+            }
+            if (c == '#' && lineStart) {                      // preprocesador
+                while (i < n && s[i] != '\n') ++i;
+                continue;
+            }
+            lineStart = false;
+            if (c == '/' && i + 1 < n && s[i + 1] == '/') {
+                while (i < n && s[i] != '\n') ++i;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && s[i + 1] == '*') {
+                size_t end = s.find("*/", i + 2);
+                end = end == std::string::npos ? n : end + 2;
+                line += (int)std::count(s.begin() + i, s.begin() + end, '\n');
+                i = end;
+                continue;
+            }
+            if (c == '"' || c == '\'') {
+                size_t j = i + 1;
+                while (j < n && s[j] != c && s[j] != '\n') j += s[j] == '\\' ? 2 : 1;
+                t_.push_back({ Kind::Literal, "", line });
+                i = std::min(n, j + 1);
+                continue;
+            }
+            if (std::isalpha((unsigned char)c) || c == '_') {
+                size_t j = i;
+                while (j < n && (std::isalnum((unsigned char)s[j]) || s[j] == '_')) ++j;
+                t_.push_back({ Kind::Ident, s.substr(i, j - i), line });
+                i = j;
+                continue;
+            }
+            if (std::isdigit((unsigned char)c)) {
+                size_t j = i;
+                while (j < n && (std::isalnum((unsigned char)s[j]) || s[j] == '.' || s[j] == '\'')) ++j;
+                t_.push_back({ Kind::Number, s.substr(i, j - i), line });
+                i = j;
+                continue;
+            }
+            // '<' y '>' nunca se juntan entre sí (plantillas anidadas, cout <<)
+            std::string op(1, c);
+            for (const char* o : OPS2) {
+                if (s.compare(i, 2, o) == 0) {
+                    op = o;
+                    break;
+                }
+            }
+            t_.push_back({ Kind::Punct, op, line });
+            i += op.size();
+        }
+    }
+
+    // ---------------- helpers ----------------
+
+    bool is(size_t i, const char* text) const { return i < t_.size() && t_[i].text == text; }
+    bool ident(size_t i) const { return i < t_.size() && t_[i].kind == Kind::Ident; }
+
+    // Índice del cierre que empareja con el '(' / '{' / '[' en i
+    size_t match(size_t i) const {
+        const std::string& open = t_[i].text;
+        const char* close = open == "(" ? ")" : open == "{" ? "}" : "]";
+        int depth = 0;
+        for (size_t j = i; j < t_.size(); ++j) {
+            if (t_[j].text == open) ++depth;
+            else if (t_[j].text == close && --depth == 0) return j;
+        }
+        return t_.size() - 1;
+    }
+
+    // Índice siguiente al final de la sentencia que empieza en i
+    size_t statement_end(size_t i, size_t end) const {
+        if (i >= end) return end;
+        if (is(i, "{")) return std::min(end, match(i) + 1);
+        if (is(i, "for") || is(i, "while") || is(i, "switch")) {
+            if (!is(i + 1, "(")) return i + 1;
+            return statement_end(match(i + 1) + 1, end);
+        }
+        if (is(i, "if")) {
+            size_t j = is(i + 1, "(") ? statement_end(match(i + 1) + 1, end) : i + 1;
+            return is(j, "else") ? statement_end(j + 1, end) : j;
+        }
+        if (is(i, "do")) {
+            size_t j = statement_end(i + 1, end);
+            if (is(j, "while") && is(j + 1, "(")) j = match(j + 1) + 1;
+            return is(j, ";") ? j + 1 : j;
+        }
+        int depth = 0;
+        for (size_t j = i; j < end; ++j) {
+            const std::string& x = t_[j].text;
+            if (x == "(" || x == "{" || x == "[") ++depth;
+            else if (x == ")" || x == "}" || x == "]") --depth;
+            else if (x == ";" && depth == 0) return j + 1;
+        }
+        return end;
+    }
+
+    static std::optional<Container> container_of(const std::string& type) {
+        static const std::unordered_map<std::string, Container> TYPES = {
+            {"vector", Container::Sequence}, {"deque", Container::Sequence},
+            {"string", Container::Sequence}, {"basic_string", Container::Sequence},
+            {"map", Container::Ordered}, {"set", Container::Ordered},
+            {"multimap", Container::Ordered}, {"multiset", Container::Ordered},
+            {"unordered_map", Container::Hashed}, {"unordered_set", Container::Hashed},
+            {"unordered_multimap", Container::Hashed}, {"unordered_multiset", Container::Hashed},
+            {"priority_queue", Container::Heap},
+            {"list", Container::List}, {"forward_list", Container::List},
+        };
+        auto it = TYPES.find(type);
+        if (it == TYPES.end()) return std::nullopt;
+        return it->second;
+    }
+
+    // Tras un tipo contenedor en i: salta <...>, &, * y const; devuelve el
+    // índice del nombre declarado (o npos) e indica si es referencia/puntero
+    size_t declared_name(size_t i, bool& byRef) const {
+        size_t j = i + 1;
+        if (is(j, "<")) {
+            int depth = 0;
+            for (; j < t_.size(); ++j) {
+                if (is(j, "<")) ++depth;
+                else if (is(j, ">") && --depth == 0) break;
+                else if (is(j, ";") || is(j, "{")) return std::string::npos;
+            }
+            ++j;
+        }
+        byRef = false;
+        while (is(j, "&") || is(j, "*") || is(j, "&&") || is(j, "const")) {
+            if (!is(j, "const")) byRef = true;
+            ++j;
+        }
+        return ident(j) ? j : std::string::npos;
+    }
+
+    void collect_declarations() {
+        for (size_t i = 0; i < t_.size(); ++i) {
+            if (!ident(i) || is(i + 1, "::")) continue;
+            auto kind = container_of(t_[i].text);
+            if (!kind) continue;
+            bool byRef = false;
+            size_t name = declared_name(i, byRef);
+            if (name != std::string::npos) vars_[t_[name].text] = *kind;
+        }
+    }
+
+    void collect_functions() {
+        static const std::unordered_set<std::string> NOT_FUNCS = {
+            "if", "for", "while", "switch", "catch", "return", "sizeof", "do", "else" };
+        for (size_t i = 0; i + 1 < t_.size(); ++i) {
+            if (!ident(i) || !is(i + 1, "(") || NOT_FUNCS.count(t_[i].text)) continue;
+            if (i > 0 && (is(i - 1, ".") || is(i - 1, "->"))) continue;
+            size_t close = match(i + 1);
+            size_t j = close + 1;
+            while (is(j, "const") || is(j, "override") || is(j, "noexcept") || is(j, "final")) ++j;
+            if (!is(j, "{")) continue;
+
+            Function f;
+            f.name = t_[i].text;
+            f.line = t_[i].line;
+            f.bodyBegin = j;
+            f.bodyEnd = match(j);
+            for (size_t k = i + 2; k < close; ++k) {
+                if (!ident(k) || !container_of(t_[k].text) || is(k + 1, "::")) continue;
+                bool byRef = false;
+                size_t name = declared_name(k, byRef);
+                if (name != std::string::npos && name < close && !byRef) f.byValue.push_back(t_[name].text);
+            }
+            funcs_.push_back(std::move(f));
+        }
+    }
+
+    void hint(int line, const std::string& key, const std::string& text) {
+        if (!record_ || hints_.size() >= MAX_HINTS) return;
+        if (!hintKeys_.insert(key + "@" + std::to_string(line)).second) return;
+        hints_.push_back("Línea " + std::to_string(line) + ": " + text);
+    }
+
+    // ¿Hay una reducción a la mitad (x / 2, x >> 1, x /= 2, x *= 2) en [b, e)?
+    bool halves(size_t b, size_t e) const {
+        for (size_t i = b; i < e; ++i) {
+            if ((is(i, "/") || is(i, "/=") || is(i, "*=")) && is(i + 1, "2")) return true;
+            if (is(i, ">") && (is(i + 1, ">") || is(i + 1, ">=")) && i + 2 < t_.size()
+                && t_[i + 2].kind == Kind::Number) return true;
+        }
+        return false;
+    }
+
+    // ---------------- análisis ----------------
+
+    struct Loop {
+        size_t headBegin = 0, headEnd = 0;   // condición / cabecera
+        size_t bodyBegin = 0, bodyEnd = 0;
+        size_t end = 0;                      // siguiente a la sentencia completa
+        Complexity cost = Complexity::linear();
+    };
+
+    Loop parse_loop(size_t i, size_t end) const {
+        Loop L;
+        L.end = statement_end(i, end);
+        auto body_range = [&](size_t b) {
+            if (is(b, "{")) {
+                L.bodyBegin = b + 1;
+                L.bodyEnd = match(b);
+            }
+            else {
+                L.bodyBegin = b;
+                L.bodyEnd = statement_end(b, end);
+            }
+        };
+
+        if (is(i, "do")) {
+            body_range(i + 1);
+            size_t w = statement_end(i + 1, end);
+            if (is(w, "while") && is(w + 1, "(")) {
+                L.headBegin = w + 2;
+                L.headEnd = match(w + 1);
+            }
+            if (halves(L.headBegin, L.headEnd) || halves(L.bodyBegin, L.bodyEnd)) L.cost = Complexity::log_n();
+            return L;
+        }
+        if (!is(i + 1, "(")) {
+            L.bodyBegin = L.bodyEnd = L.end;
+            return L;
+        }
+        L.headBegin = i + 2;
+        L.headEnd = match(i + 1);
+        body_range(L.headEnd + 1);
+
+        if (is(i, "while")) {
+            if (halves(L.headBegin, L.headEnd) || halves(L.bodyBegin, L.bodyEnd)) L.cost = Complexity::log_n();
+            return L;
+        }
+
+        // for: separar init; cond; update (o detectar range-for)
+        std::vector<size_t> semis;
+        int depth = 0;
+        for (size_t k = L.headBegin; k < L.headEnd; ++k) {
+            if (is(k, "(") || is(k, "[") || is(k, "{")) ++depth;
+            else if (is(k, ")") || is(k, "]") || is(k, "}")) --depth;
+            else if (depth == 0 && is(k, ";")) semis.push_back(k);
+            else if (depth == 0 && is(k, ":") && semis.empty()) return L;   // range-for: O(n)
+        }
+        if (semis.size() != 2) return L;
+        size_t condB = semis[0] + 1, condE = semis[1];
+        size_t updB = semis[1] + 1, updE = L.headEnd;
+        for (size_t k = updB; k < updE; ++k) {
+            if (is(k, "*=") || is(k, "/=") || (is(k, ">") && is(k + 1, ">="))) {
+                L.cost = Complexity::log_n();
+                return L;
+            }
+        }
+        // Cota literal (i < 26): número de vueltas constante
+        for (size_t k = condB; k + 1 < condE; ++k) {
+            if ((is(k, "<") || is(k, "<=") || is(k, ">") || is(k, ">=") || is(k, "!="))
+                && t_[k + 1].kind == Kind::Number && k + 2 == condE) {
+                L.cost = Complexity::constant();
+            }
+        }
+        return L;
+    }
+
+    // Costo de la operación que empieza en el token i (si la hay)
+    bool op_cost(size_t i, const std::string& fn, Complexity& cost, std::string& what, std::string& kind) const {
+        if (!ident(i)) return false;
+        const std::string& x = t_[i].text;
+
+        // Método sobre una variable de tipo conocido: v.erase(...), m.find(...)
+        if (i >= 2 && (is(i - 1, ".") || is(i - 1, "->")) && is(i + 1, "(") && ident(i - 2)) {
+            auto v = vars_.find(t_[i - 2].text);
+            if (v == vars_.end()) return false;
+            what = t_[i - 2].text + "." + x + "()";
+            switch (v->second) {
+            case Container::Sequence:
+                if (x == "find" || x == "rfind" || x == "substr" || x == "compare") {
+                    cost = Complexity::linear();
+                    kind = x == "substr" ? "substr" : "search";
+                    return true;
+                }
+                if (x == "erase" || x == "insert") {
+                    cost = Complexity::linear();
+                    kind = "shift";
+                    return true;
+                }
+                return false;
+            case Container::Ordered:
+                if (x == "find" || x == "count" || x == "insert" || x == "erase" || x == "emplace"
+                    || x == "lower_bound" || x == "upper_bound" || x == "contains") {
+                    cost = Complexity::log_n();
+                    kind = "tree";
+                    return true;
+                }
+                return false;
+            case Container::Heap:
+                if (x == "push" || x == "pop" || x == "emplace") {
+                    cost = Complexity::log_n();
+                    kind = "heap";
+                    return true;
+                }
+                return false;
+            default:
+                return false;
+            }
+        }
+        if (i >= 1 && (is(i - 1, ".") || is(i - 1, "->"))) return false;
+        if (i >= 2 && is(i - 1, "::") && !is(i - 2, "std")) return false;
+
+        // m[k] sobre map/set ordenado
+        if (is(i + 1, "[")) {
+            auto v = vars_.find(x);
+            if (v != vars_.end() && v->second == Container::Ordered) {
+                cost = Complexity::log_n();
+                what = x + "[...]";
+                kind = "tree";
+                return true;
+            }
+            return false;
+        }
+
+        // s = s + ...: copia la cadena entera
+        if (is(i + 1, "=") && is(i + 2, x.c_str()) && is(i + 3, "+")) {
+            auto v = vars_.find(x);
+            if (v != vars_.end() && v->second == Container::Sequence) {
+                cost = Complexity::linear();
+                what = x + " = " + x + " + ...";
+                kind = "concat";
+                return true;
+            }
+            return false;
+        }
+
+        if (!is(i + 1, "(")) return false;
+        static const std::unordered_set<std::string> LINEAR = {
+            "find", "find_if", "count", "count_if", "accumulate", "reverse", "min_element",
+            "max_element", "fill", "copy", "remove", "remove_if", "unique", "all_of", "any_of",
+            "none_of", "iota", "equal", "search", "rotate", "replace", "transform", "memset",
+            "next_permutation", "prev_permutation", "partial_sum", "nth_element" };
+        static const std::unordered_set<std::string> LOG = {
+            "lower_bound", "upper_bound", "binary_search", "equal_range" };
+        what = x + "()";
+        if (x == "sort" || x == "stable_sort" || x == "partial_sort") {
+            cost = Complexity::n_log_n();
+            kind = "sort";
+            return true;
+        }
+        if (LINEAR.count(x)) {
+            cost = Complexity::linear();
+            kind = (x == "find" || x == "find_if" || x == "count" || x == "count_if") ? "search" : "algo";
+            return true;
+        }
+        if (LOG.count(x)) {
+            cost = Complexity::log_n();
+            kind = "bsearch";
+            return true;
+        }
+        auto f = funcCost_.find(x);
+        if (f != funcCost_.end() && x != fn && !(f->second == Complexity::constant())) {
+            cost = f->second;
+            kind = "call";
+            return true;
+        }
+        return false;
+    }
+
+    void op_hint(int line, const std::string& kind, const std::string& what, const Complexity& cost,
+        const Complexity& total) {
+        const std::string tot = " (" + total.str() + " en total).";
+        if (kind == "search") {
+            hint(line, kind, "`" + what + "` es una búsqueda lineal dentro de un bucle" + tot
+                + " Un unordered_set/unordered_map la deja en O(1).");
+        }
+        else if (kind == "shift") {
+            hint(line, kind, "`" + what + "` dentro de un bucle desplaza los elementos siguientes, O(n) por llamada" + tot);
+        }
+        else if (kind == "sort") {
+            hint(line, kind, "`" + what + "` dentro de un bucle" + tot + " Si puedes, ordena una sola vez antes del bucle.");
+        }
+        else if (kind == "substr") {
+            hint(line, kind, "`" + what + "` copia la cadena en cada vuelta" + tot + " Compara por índices o usa string_view.");
+        }
+        else if (kind == "concat") {
+            hint(line, kind, "`" + what + "` copia la cadena completa en cada vuelta" + tot + " Usa `+=`.");
+        }
+        else if (kind == "call") {
+            hint(line, kind, "llamar a `" + what + "` (" + cost.str() + ") dentro de un bucle multiplica su costo" + tot);
+        }
+        else if (kind == "algo") {
+            hint(line, kind, "`" + what + "` recorre todo el rango en cada vuelta del bucle" + tot);
+        }
+    }
+
+    // Peor costo dentro de [b, e) estando anidado en `outer`
+    Complexity analyze(size_t b, size_t e, const Complexity& outer, const std::string& fn) {
+        Complexity worst = outer;
+        for (size_t i = b; i < e;) {
+            if (is(i, "for") || is(i, "while") || is(i, "do")) {
+                Loop L = parse_loop(i, e);
+                Complexity inner = outer * L.cost;
+                if (outer.poly >= 1 && L.cost.poly >= 1) {
+                    hint(t_[i].line, "nested", "bucle dentro de otro bucle (" + inner.str()
+                        + "). ¿Puedes evitar la vuelta interna con un hash map, dos punteros u ordenando antes?");
+                }
+                worst = std::max(worst, analyze(L.headBegin, L.headEnd, inner, fn));
+                worst = std::max(worst, analyze(L.bodyBegin, L.bodyEnd, inner, fn));
+                i = std::max(L.end, i + 1);
+                continue;
+            }
+            if (outer.poly >= 1 && is(i, "endl")) {
+                hint(t_[i].line, "endl", "`endl` vacía el buffer en cada vuelta; usa '\\n'.");
+            }
+            Complexity cost;
+            std::string what, kind;
+            if (op_cost(i, fn, cost, what, kind)) {
+                Complexity total = outer * cost;
+                worst = std::max(worst, total);
+                if (outer.poly >= 1 && cost.poly >= 1) op_hint(t_[i].line, kind, what, cost, total);
+            }
+            ++i;
+        }
+        return worst;
+    }
+
+    Complexity function_cost(const Function& f) {
+        Complexity body = analyze(f.bodyBegin + 1, f.bodyEnd, Complexity::constant(), f.name);
+
+        int selfCalls = 0;
+        bool memo = false;
+        for (size_t i = f.bodyBegin + 1; i < f.bodyEnd; ++i) {
+            if (!ident(i)) continue;
+            if (t_[i].text == f.name && is(i + 1, "(") && !is(i - 1, ".") && !is(i - 1, "->")) ++selfCalls;
+            std::string low = t_[i].text;
+            std::transform(low.begin(), low.end(), low.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+            if (low.find("memo") != std::string::npos || low == "dp" || low.find("cache") != std::string::npos) memo = true;
+        }
+        if (selfCalls == 0) return body;
+
+        bool divide = halves(f.bodyBegin + 1, f.bodyEnd);
+        for (size_t i = f.bodyBegin + 1; i < f.bodyEnd && !divide; ++i) divide = is(i, "mid");
+
+        for (const auto& v : f.byValue) {
+            hint(f.line, "byvalue-" + v, "`" + f.name + "` recibe `" + v + "` por valor y lo copia en cada llamada "
+                "recursiva; pásalo por referencia (`const &`).");
+        }
+
+        if (selfCalls == 1) return body * (divide ? Complexity::log_n() : Complexity::linear());
+        if (divide) {
+            // T(n) = 2T(n/2) + O(n^k): k=0 -> O(n), k=1 -> O(n log n), k>=2 -> O(n^k)
+            if (body.poly == 0) return Complexity::linear();
+            if (body.poly == 1) return body * Complexity::log_n();
+            return body;
+        }
+        if (memo) return body * Complexity::linear();
+        hint(f.line, "exp", "`" + f.name + "` se llama a sí misma " + std::to_string(selfCalls)
+            + " veces sin guardar resultados: crecimiento exponencial (O(2^n)). Memoiza los subproblemas (memo/DP).");
+        Complexity c = body;
+        c.exp = true;
+        return c;
+    }
+
+    std::vector<Token> t_;
+    std::unordered_map<std::string, Container> vars_;
+    std::vector<Function> funcs_;
+    std::unordered_map<std::string, Complexity> funcCost_;
+    std::vector<std::string> hints_;
+    std::set<std::string> hintKeys_;
+    bool record_ = false;
+};
+
+inline ComplexityReport estimate_complexity(const std::string& source) {
+    return ComplexityEstimator(source).run();
+}
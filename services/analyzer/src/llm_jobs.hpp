@@ -0,0 +1,395 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "httplib.h"
+#include "json.hpp"
+#include "analysis_cache.hpp"
+#include "trace.hpp"
+
+// ========================== LLM JOBS ===========================
+// Trabajos en segundo plano contra llm_proxy.py. POST /analysis responde al
+// instante con las pistas por reglas y encola aquí la llamada a la IA; un
+// número fijo de hilos (`workers`) hace las llamadas, así que nunca hay más
+// de `workers` peticiones abiertas contra el proxy, y la cola se limita a
+// `maxQueue`. La respuesta llega en streaming y se parte en líneas a medida
+// que se recibe; quien consulte (long-poll o SSE) ve cada línea nueva.
+// Delante hay una AnalysisCache: una clave ya respondida da un trabajo
+// terminado al instante, y mientras una clave está en curso las peticiones
+// iguales se suman a ese mismo trabajo (single-flight).
+class LlmJobs {
+public:
+    struct Config {
+        std::string host = "localhost";
+        int port = 8090;
+        size_t workers = 4;
+        size_t maxQueue = 32;
+        int connectTimeoutMs = 2000;
+        int readTimeoutMs = 60000;
+        std::chrono::seconds ttl{ 600 };   // vida de un trabajo terminado
+        AnalysisCache::Config cache;
+        // Se llama tras cada llamada al proxy con su duración y si fue bien
+        std::function<void(double seconds, bool ok)> onCall;
+    };
+
+    struct Job {
+        std::string id;
+        std::string status;               // queued -> running -> done | error
+        std::vector<std::string> lines;   // líneas completas recibidas de la IA
+        std::string error;
+        bool cached = false;              // respuesta servida desde la caché
+        uint64_t version = 0;             // se incrementa en cada cambio
+        std::chrono::steady_clock::time_point finishedAt{};
+
+        // Solo para el hilo que hace la llamada
+        std::string prompt;
+        std::string problemId;
+        std::string key;                  // clave de caché ("" = sin caché)
+        std::string partial;              // resto sin salto de línea todavía
+        std::string streamError;          // el proxy cerró el stream con STREAM_ERROR
+        trace::Context trace;             // span de la petición que lo encoló
+        std::chrono::steady_clock::time_point queuedAt{};
+    };
+
+    struct Stats {
+        size_t workers = 0;
+        size_t running = 0;
+        size_t queued = 0;
+        size_t capacity = 0;
+        size_t jobs = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint64_t rejected = 0;
+        uint64_t coalesced = 0;           // peticiones unidas a un trabajo en curso
+    };
+
+    ~LlmJobs() { stop(); }
+
+    void start(const Config& cfg) {
+        cfg_ = cfg;
+        if (cfg_.workers == 0) cfg_.workers = 1;
+        cache_.open(cfg_.cache);
+        for (size_t i = 0; i < cfg_.workers; ++i) {
+            threads_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (stopping_) return;
+            stopping_ = true;
+        }
+        queueCv_.notify_all();
+        changed_.notify_all();
+        for (auto& t : threads_) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    // Encola una llamada; devuelve el id o "" si la cola está llena. Con
+    // `key` se reutiliza un trabajo igual en curso o una respuesta cacheada.
+    // `parent` cuelga la llamada al proxy de la traza de quien la pidió.
+    std::string submit(std::string prompt, std::string problemId, const std::string& key = "",
+        const trace::Context& parent = {}) {
+        if (!key.empty()) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (auto id = joinable_locked(key); !id.empty()) return id;
+            }
+            // La caché puede leer disco: fuera del lock de los trabajos
+            if (auto lines = cache_.get(key)) {
+                std::lock_guard<std::mutex> lk(m_);
+                if (auto id = joinable_locked(key); !id.empty()) return id;
+                sweep_locked();
+                Job j;
+                j.id = new_id_locked();
+                j.status = "done";
+                j.lines = std::move(*lines);
+                j.cached = true;
+                j.key = key;
+                j.version = 1;
+                j.finishedAt = std::chrono::steady_clock::now();
+                std::string id = j.id;
+                jobs_.emplace(id, std::move(j));
+                return id;
+            }
+        }
+
+        std::lock_guard<std::mutex> lk(m_);
+        if (!key.empty()) {
+            if (auto id = joinable_locked(key); !id.empty()) return id;
+        }
+        sweep_locked();
+        if (queue_.size() >= cfg_.maxQueue) {
+            ++rejected_;
+            return "";
+        }
+        Job j;
+        j.id = new_id_locked();
+        j.status = "queued";
+        j.version = 1;
+        j.prompt = std::move(prompt);
+        j.problemId = std::move(problemId);
+        j.key = key;
+        j.trace = parent;
+        j.queuedAt = std::chrono::steady_clock::now();
+        std::string id = j.id;
+        jobs_.emplace(id, std::move(j));
+        if (!key.empty()) byKey_[key] = id;
+        queue_.push_back(id);
+        queueCv_.notify_one();
+        return id;
+    }
+
+    // Espera hasta `timeout` a que la versión supere `since` y lee el trabajo
+    // (aunque venza el plazo). Devuelve false si no existe.
+    bool wait_read(const std::string& id, uint64_t since, std::chrono::milliseconds timeout,
+        const std::function<void(const Job&)>& f) {
+        std::unique_lock<std::mutex> lk(m_);
+        changed_.wait_for(lk, timeout, [&] {
+            auto it = jobs_.find(id);
+            return stopping_ || it == jobs_.end() || it->second.version > since;
+            });
+        auto it = jobs_.find(id);
+        if (it == jobs_.end()) return false;
+        f(it->second);
+        return true;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return Stats{ cfg_.workers, running_, queue_.size(), cfg_.maxQueue, jobs_.size(),
+            completed_, failed_, rejected_, coalesced_ };
+    }
+
+    AnalysisCache::Stats cache_stats() const { return cache_.stats(); }
+
+    // Quita espacios al inicio y fin; la IA suele dejar líneas en blanco
+    // Marca de llm_proxy.py al inicio de una línea: el stream se cortó y el
+    // resto de la línea es el motivo. Esa respuesta no se guarda en la caché.
+    static constexpr char STREAM_ERROR = '\x1e';
+
+    static std::string clean_line(const std::string& line) {
+        auto start = line.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        auto end = line.find_last_not_of(" \t\r\n");
+        return line.substr(start, end - start + 1);
+    }
+
+private:
+    // Trabajo en curso con la misma clave; los terminados ya están en la caché
+    std::string joinable_locked(const std::string& key) {
+        auto k = byKey_.find(key);
+        if (k == byKey_.end()) return "";
+        auto it = jobs_.find(k->second);
+        if (it == jobs_.end() || it->second.status == "done" || it->second.status == "error") {
+            byKey_.erase(k);
+            return "";
+        }
+        ++coalesced_;
+        return k->second;
+    }
+
+    std::string new_id_locked() {
+        static const char* HEX = "0123456789abcdef";
+        std::string id;
+        do {
+            uint64_t r = rng_();
+            id.assign(16, '0');
+            for (int i = 15; i >= 0; --i, r >>= 4) id[i] = HEX[r & 0xF];
+        } while (jobs_.count(id));
+        return id;
+    }
+
+    // Expulsa los trabajos terminados hace más de `ttl`
+    void sweep_locked() {
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = jobs_.begin(); it != jobs_.end();) {
+            bool finished = it->second.status == "done" || it->second.status == "error";
+            if (finished && now - it->second.finishedAt >= cfg_.ttl) {
+                auto k = byKey_.find(it->second.key);
+                if (k != byKey_.end() && k->second == it->first) byKey_.erase(k);
+                it = jobs_.erase(it);
+            }
+            else ++it;
+        }
+    }
+
+    void worker_loop() {
+        for (;;) {
+            std::string id, prompt, problemId;
+            trace::Context parent;
+            std::chrono::steady_clock::time_point queuedAt;
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                queueCv_.wait(lk, [&] { return stopping_ || !queue_.empty(); });
+                if (stopping_) return;
+                id = queue_.front();
+                queue_.pop_front();
+                auto it = jobs_.find(id);
+                if (it == jobs_.end()) continue;
+                it->second.status = "running";
+                ++it->second.version;
+                prompt = std::move(it->second.prompt);
+                problemId = std::move(it->second.problemId);
+                parent = it->second.trace;
+                queuedAt = it->second.queuedAt;
+                ++running_;
+            }
+            changed_.notify_all();
+
+            trace::Span("llm.queue_wait", parent, queuedAt).attr("jobId", id);
+            trace::Span span("llm.call", parent);
+            const auto t0 = std::chrono::steady_clock::now();
+            std::string error = call(id, prompt, problemId, span.context());
+            span.attr("jobId", id).attr("ok", error.empty()).end();
+            if (cfg_.onCall) {
+                cfg_.onCall(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(),
+                    error.empty());
+            }
+
+            std::string key;
+            AnalysisCache::Lines lines;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                --running_;
+                auto it = jobs_.find(id);
+                if (it != jobs_.end()) {
+                    Job& j = it->second;
+                    std::string rest = clean_line(j.partial);
+                    if (!rest.empty()) j.lines.push_back(std::move(rest));
+                    j.partial.clear();
+                    j.error = error;
+                    j.status = error.empty() ? "done" : "error";
+                    j.finishedAt = std::chrono::steady_clock::now();
+                    ++j.version;
+                    if (error.empty() && !j.key.empty()) {
+                        key = j.key;
+                        lines = j.lines;
+                    }
+                }
+                if (error.empty()) ++completed_;
+                else ++failed_;
+            }
+            changed_.notify_all();
+            if (!key.empty()) cache_.put(key, lines);
+        }
+    }
+
+    // Añade un trozo de la respuesta y publica las líneas completas
+    void feed(const std::string& id, const char* data, size_t n) {
+        bool added = false;
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = jobs_.find(id);
+            if (it == jobs_.end()) return;
+            Job& j = it->second;
+            j.partial.append(data, n);
+            size_t pos;
+            while ((pos = j.partial.find('\n')) != std::string::npos) {
+                std::string line = clean_line(j.partial.substr(0, pos));
+                j.partial.erase(0, pos + 1);
+                if (line.empty()) continue;
+                if (line[0] == STREAM_ERROR) {
+                    j.streamError = clean_line(line.substr(1));
+                    continue;
+                }
+                j.lines.push_back(std::move(line));
+                added = true;
+            }
+            if (added) ++j.version;
+        }
+        if (added) changed_.notify_all();
+    }
+
+    // Llama a /llm-feedback/stream; devuelve "" si todo fue bien o el error
+    std::string call(const std::string& id, const std::string& prompt, const std::string& problemId,
+        const trace::Context& ctx) {
+        httplib::Client cli(cfg_.host, cfg_.port);
+        cli.set_connection_timeout(std::chrono::milliseconds(cfg_.connectTimeoutMs));
+        cli.set_read_timeout(std::chrono::milliseconds(cfg_.readTimeoutMs));
+
+        nlohmann::json payload = {
+            {"prompt", prompt},
+            {"problemId", problemId}
+        };
+
+        int status = 0;
+        std::string errorBody;
+        httplib::Request req;
+        req.method = "POST";
+        req.path = "/llm-feedback/stream";
+        req.body = payload.dump();
+        req.set_header("Content-Type", "application/json");
+        if (ctx.valid()) req.set_header("traceparent", ctx.traceparent());
+        req.response_handler = [&](const httplib::Response& r) {
+            status = r.status;
+            return true;
+        };
+        req.content_receiver = [&](const char* data, size_t n, size_t, size_t) {
+            if (status == 200) feed(id, data, n);
+            else if (errorBody.size() < 4096) errorBody.append(data, n);
+            return true;
+        };
+
+        auto res = cli.send(req);
+        if (!res) {
+            if (status == 200) return "Se cortó la respuesta del servicio LLM.";
+            return "No se pudo contactar al servicio LLM (llm_proxy en puerto "
+                + std::to_string(cfg_.port) + "). Verifica que llm_proxy.py esté corriendo.";
+        }
+        if (status != 200) {
+            auto body = nlohmann::json::parse(errorBody, nullptr, false);
+            const bool hasMsg = body.is_object() && body.contains("error") && body["error"].is_string();
+            // 429: el mensaje del proxy ya está escrito para el estudiante
+            if (status == 429 && hasMsg) return body["error"].get<std::string>();
+            if (hasMsg) return "Error desde el servicio LLM: " + body["error"].get<std::string>();
+            return "Error desde el servicio LLM: HTTP " + std::to_string(status);
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = jobs_.find(id);
+            if (it != jobs_.end()) {
+                Job& j = it->second;
+                // La marca puede llegar en la última línea, sin salto final
+                std::string rest = clean_line(j.partial);
+                if (!rest.empty() && rest[0] == STREAM_ERROR) {
+                    j.streamError = clean_line(rest.substr(1));
+                    j.partial.clear();
+                }
+                if (!j.streamError.empty()) return j.streamError;
+            }
+        }
+        return "";
+    }
+
+    Config cfg_;
+    std::vector<std::thread> threads_;
+    AnalysisCache cache_;
+
+    mutable std::mutex m_;
+    std::condition_variable queueCv_;
+    std::condition_variable changed_;
+    std::unordered_map<std::string, Job> jobs_;
+    std::deque<std::string> queue_;
+    std::unordered_map<std::string, std::string> byKey_;   // clave de caché -> id
+    std::mt19937_64 rng_{ std::random_device{}() };
+    size_t running_ = 0;
+    uint64_t completed_ = 0;
+    uint64_t failed_ = 0;
+    uint64_t rejected_ = 0;
+    uint64_t coalesced_ = 0;
+    bool stopping_ = false;
+};
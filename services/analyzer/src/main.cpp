@@ -1,11 +1,20 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <sstream>
+#include <cstdlib>
+#include <memory>
+#include <optional>
 
 #include "httplib.h"
 #include "json.hpp"
+#include "llm_jobs.hpp"
+#include "complexity.hpp"
+#include "http_metrics.hpp"
+#include "http_trace.hpp"
 
 using json = nlohmann::json;
 
@@ -26,7 +35,8 @@ struct AnalysisResult {
 static void set_cors(httplib::Response& res) {
     res.set_header("Access-Control-Allow-Origin", "*");
     res.set_header("Access-Control-Allow-Methods", "GET,POST,OPTIONS");
-    res.set_header("Access-Control-Allow-Headers", "Content-Type");
+    res.set_header("Access-Control-Allow-Headers", "Content-Type, traceparent");
+    res.set_header("Access-Control-Expose-Headers", "traceresponse");
 }
 
 // -------------------- HINTS BASE (REGLAS) --------------------
@@ -136,6 +146,88 @@ static AnalysisResult analyze_binary_search(const AnalysisRequest& req) {
     }
 }
 
+// -------------------- COMPLEJIDAD ESTÁTICA --------------------
+
+// Clase medida por el evaluador ("complexity" del envío, si se pidió medir)
+static std::optional<Complexity> measured_complexity(const AnalysisRequest& req) {
+    if (!req.results.is_object() || !req.results.contains("complexity")) return std::nullopt;
+    const auto& c = req.results["complexity"];
+    if (!c.is_object() || !c.contains("class") || !c["class"].is_string()) return std::nullopt;
+    return Complexity::parse(c["class"].get<std::string>());
+}
+
+// Sustituye la complejidad fija de las reglas por la estimada sobre el código
+// real y añade las pistas de rendimiento; si la estimación es peor que la que
+// esperan las reglas para el problema, lo dice.
+static void apply_static_complexity(const AnalysisRequest& req, AnalysisResult& ar) {
+    ComplexityReport cx = estimate_complexity(req.source);
+    auto measured = measured_complexity(req);
+    if (!cx.analyzed && !measured) return;
+
+    // La medición manda sobre la lectura del código: es lo que de verdad pasó
+    auto expected = Complexity::parse(ar.complexityEstimate);
+    const Complexity actual = measured ? *measured : cx.complexity;
+    ar.complexityEstimate = actual.str();
+    if (expected && *expected < actual) {
+        ar.hints.push_back(std::string(measured ? "Medida con entradas crecientes, tu solución es "
+            : "Tu solución parece ") + actual.str()
+            + "; este problema se puede resolver en " + expected->str() + ".");
+    }
+    ar.hints.insert(ar.hints.end(), cx.hints.begin(), cx.hints.end());
+}
+
+// -------------------- MEMORIA --------------------
+
+// Reservas de la solución medidas por el Evaluator ("heap" del envío):
+// operator new contado dentro del harness, sumado sobre los casos
+struct HeapUsage {
+    long long allocs = 0;
+    long long bytes = 0;
+    long long peakBytes = 0;
+};
+
+static std::optional<HeapUsage> measured_heap(const AnalysisRequest& req) {
+    if (!req.results.is_object() || !req.results.contains("heap")) return std::nullopt;
+    const auto& h = req.results["heap"];
+    if (!h.is_object()) return std::nullopt;
+    HeapUsage u;
+    u.allocs = h.value("allocs", 0LL);
+    u.bytes = h.value("bytes", 0LL);
+    u.peakBytes = h.value("peakBytes", 0LL);
+    return u;
+}
+
+static std::string human_bytes(long long b) {
+    if (b >= 10 * 1024 * 1024) return std::to_string(b / (1024 * 1024)) + " MB";
+    if (b >= 10 * 1024) return std::to_string(b / 1024) + " KB";
+    return std::to_string(b) + " bytes";
+}
+
+// Pide mucha más memoria de la que llega a tener viva: crea y destruye
+// estructuras en bucle. Con pocas reservas no hay patrón que señalar.
+static constexpr long long CHURN_RATIO = 4;
+static constexpr long long CHURN_MIN_ALLOCS = 32;
+
+static void apply_memory_hints(const AnalysisRequest& req, AnalysisResult& ar) {
+    auto heap = measured_heap(req);
+    if (!heap || heap->allocs == 0) return;
+
+    const bool inPlace = std::find(ar.probablePatterns.begin(), ar.probablePatterns.end(), "in-place")
+        != ar.probablePatterns.end();
+    if (inPlace) {
+        ar.hints.push_back("Este problema se resuelve in-place, pero tu solución reservó "
+            + human_bytes(heap->bytes) + " en " + std::to_string(heap->allocs)
+            + " reservas: trabaja directamente sobre la entrada.");
+    }
+    if (heap->allocs >= CHURN_MIN_ALLOCS && heap->bytes >= CHURN_RATIO * std::max(1LL, heap->peakBytes)) {
+        ar.hints.push_back("Tu solución pidió " + human_bytes(heap->bytes) + " en "
+            + std::to_string(heap->allocs) + " reservas, pero nunca tuvo más de "
+            + human_bytes(heap->peakBytes) + " a la vez: estás creando y destruyendo estructuras "
+            "una y otra vez (copias de vectores, un hash map reconstruido en cada iteración o consulta). "
+            "Pasa los contenedores por referencia y créalos una sola vez.");
+    }
+}
+
 // -------------------- PROMPT PARA LA IA --------------------
 
 static std::string build_llm_prompt(const AnalysisRequest& req) {
@@ -179,6 +271,13 @@ static std::string build_llm_prompt(const AnalysisRequest& req) {
     else {
         oss << "No se recibieron resultados detallados.\n";
     }
+    if (auto measured = measured_complexity(req)) {
+        oss << "Complejidad medida con entradas crecientes: " << measured->str() << "\n";
+    }
+    if (auto heap = measured_heap(req)) {
+        oss << "Memoria dinámica de la solución (todos los casos): " << heap->allocs << " reservas, "
+            << human_bytes(heap->bytes) << " pedidos, pico de " << human_bytes(heap->peakBytes) << " vivos.\n";
+    }
 
     // Código fuente (truncado)
     if (!req.source.empty()) {
@@ -199,55 +298,142 @@ static std::string build_llm_prompt(const AnalysisRequest& req) {
     return oss.str();
 }
 
-// -------------------- LLAMAR AL PROXY PYTHON --------------------
-
-static std::string call_llm_via_proxy(const AnalysisRequest& req) {
-    std::string prompt = build_llm_prompt(req);
+// -------------------- LLAMADAS A LA IA (EN SEGUNDO PLANO) --------------------
 
-    // Cliente HTTP hacia el proxy en Python (llm_proxy) en localhost:8090
-    httplib::Client cli("localhost", 8090);
+static LlmJobs LLM;
 
-    json payload = {
-        {"prompt", prompt},
-        {"problemId", req.problemId}
-    };
+static size_t env_size(const char* name, size_t def) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return def;
+    char* end = nullptr;
+    unsigned long long n = std::strtoull(v, &end, 10);
+    if (end == v || n == 0) return def;
+    return (size_t)n;
+}
 
-    auto res = cli.Post("/llm-feedback", payload.dump(), "application/json");
-    if (!res) {
-        return "No se pudo contactar al servicio LLM (llm_proxy en puerto 8090). "
-            "Verifica que llm_proxy.py esté corriendo.";
-    }
-    if (res->status != 200) {
-        return "Error desde el servicio LLM: HTTP " + std::to_string(res->status);
-    }
-
-    try {
-        auto body = json::parse(res->body);
-        if (body.contains("feedback")) {
-            return body["feedback"].get<std::string>();
-        }
-        else {
-            return "Respuesta del servicio LLM sin campo 'feedback'.";
-        }
-    }
-    catch (...) {
-        return "No se pudo parsear la respuesta del servicio LLM.";
+// Peticiones que retienen un hilo HTTP mientras esperan a la IA (streams SSE
+// y long-polls). Se acotan para que siempre queden hilos para POST /analysis
+// y /health: por encima del tope, un stream recibe 503 (la UI pasa a
+// consultar periódicamente) y un long-poll responde sin esperar.
+static std::atomic<size_t> WAITERS{ 0 };
+static size_t MAX_WAITERS = 0;
+
+static bool acquire_waiter() {
+    size_t n = WAITERS.load();
+    while (n < MAX_WAITERS) {
+        if (WAITERS.compare_exchange_weak(n, n + 1)) return true;
     }
+    return false;
 }
 
+static void release_waiter() { WAITERS.fetch_sub(1); }
+
 // -------------------- MAIN SERVER --------------------
 
 int main() {
     httplib::Server svr;
 
+    // Llamadas al proxy LLM: como mucho CC_ANA_LLM_CONCURRENCY a la vez
+    LlmJobs::Config llmCfg;
+    if (const char* h = std::getenv("CC_ANA_LLM_HOST")) llmCfg.host = h;
+    llmCfg.port = (int)env_size("CC_ANA_LLM_PORT", 8090);
+    llmCfg.workers = env_size("CC_ANA_LLM_CONCURRENCY", 4);
+    llmCfg.maxQueue = env_size("CC_ANA_LLM_QUEUE", 32);
+    llmCfg.connectTimeoutMs = (int)env_size("CC_ANA_LLM_CONNECT_MS", 2000);
+    llmCfg.readTimeoutMs = (int)env_size("CC_ANA_LLM_READ_MS", 60000);
+    llmCfg.ttl = std::chrono::seconds(env_size("CC_ANA_JOB_TTL_S", 600));
+    llmCfg.cache.maxEntries = env_size("CC_ANA_CACHE_ENTRIES", 1024);
+    llmCfg.cache.maxDiskEntries = env_size("CC_ANA_CACHE_DISK_ENTRIES", 10000);
+    llmCfg.cache.ttl = std::chrono::seconds(env_size("CC_ANA_CACHE_TTL_S", 86400));
+    if (const char* d = std::getenv("CC_ANA_CACHE_DIR")) llmCfg.cache.dir = d;
+
+    auto& reg = metrics::registry();
+    auto& llmSeconds = reg.histogram("cc_ana_llm_seconds", "Duración de las llamadas al proxy LLM",
+        { 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 20, 30, 60, 120 });
+    auto& llmCalls = reg.counter_family("cc_ana_llm_calls_total", "Llamadas al proxy LLM por resultado", { "result" });
+    llmCfg.onCall = [&llmSeconds, &llmCalls](double seconds, bool ok) {
+        llmSeconds.observe(seconds);
+        llmCalls.with({ ok ? "ok" : "error" }).inc();
+    };
+
+    // Trazas: ring buffer en memoria (GET /traces) y, opcionalmente, fichero JSONL
+    trace::Tracer::Config traceCfg;
+    traceCfg.service = "analyzer";
+    if (const char* t = std::getenv("CC_ANA_TRACE")) traceCfg.enabled = std::string(t) != "0";
+    traceCfg.capacity = env_size("CC_ANA_TRACE_BUFFER", 4096);
+    if (const char* p = std::getenv("CC_ANA_TRACE_FILE")) traceCfg.file = p;
+    trace::tracer().start(traceCfg);
+    LLM.start(llmCfg);
+
+    // Los streams SSE y los long-poll ocupan un hilo HTTP mientras esperan: por
+    // defecto uno por trabajo posible (cola + llamadas) más margen para el resto
+    const size_t httpThreads = env_size("CC_ANA_HTTP_THREADS", llmCfg.maxQueue + llmCfg.workers + 32);
+    const size_t maxWaitMs = env_size("CC_ANA_MAX_WAIT_MS", 30000);
+    MAX_WAITERS = env_size("CC_ANA_MAX_WAITERS", httpThreads > 32 ? httpThreads - 32 : httpThreads / 2 + 1);
+    if (MAX_WAITERS >= httpThreads) MAX_WAITERS = httpThreads > 1 ? httpThreads - 1 : 1;
+    svr.new_task_queue = [httpThreads] { return new httplib::ThreadPool(httpThreads); };
+
+    // Métricas leídas al vuelo de la cola de trabajos y de la caché
+    reg.gauge_fn("cc_ana_llm_workers", "Llamadas simultáneas permitidas al proxy LLM",
+        [] { return (double)LLM.stats().workers; });
+    reg.gauge_fn("cc_ana_llm_running", "Llamadas al proxy LLM en curso", [] { return (double)LLM.stats().running; });
+    reg.gauge_fn("cc_ana_llm_queue_depth", "Trabajos de IA esperando", [] { return (double)LLM.stats().queued; });
+    reg.gauge_fn("cc_ana_llm_queue_capacity", "Capacidad de la cola de IA", [] { return (double)LLM.stats().capacity; });
+    reg.counter_fn("cc_ana_llm_rejected_total", "Trabajos rechazados por cola llena",
+        [] { return (double)LLM.stats().rejected; });
+    reg.counter_fn("cc_ana_llm_coalesced_total", "Peticiones unidas a un trabajo en curso",
+        [] { return (double)LLM.stats().coalesced; });
+    reg.counter_fn("cc_ana_cache_hits_total", "Aciertos de la caché de análisis",
+        [] { return (double)LLM.cache_stats().hits; });
+    reg.counter_fn("cc_ana_cache_misses_total", "Fallos de la caché de análisis",
+        [] { return (double)LLM.cache_stats().misses; });
+    reg.gauge_fn("cc_ana_cache_entries", "Entradas de la caché de análisis en memoria",
+        [] { return (double)LLM.cache_stats().entries; });
+    reg.gauge_fn("cc_ana_http_threads", "Hilos HTTP configurados", [httpThreads] { return (double)httpThreads; });
+    reg.gauge_fn("cc_ana_http_waiters", "Streams SSE y long-polls esperando", [] { return (double)WAITERS.load(); });
+    metrics::register_process_metrics(reg);
+    metrics::instrument(svr, reg, trace::record_request);
+    trace::serve_traces(svr);
+
     svr.Options(R"(/.*)", [](const httplib::Request&, httplib::Response& res) {
         set_cors(res);
         res.status = 200;
         });
 
-    svr.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+    svr.Get("/health", [httpThreads](const httplib::Request&, httplib::Response& res) {
         set_cors(res);
-        res.set_content(R"({"ok":true})", "application/json");
+        auto st = LLM.stats();
+        auto cs = LLM.cache_stats();
+        uint64_t lookups = cs.hits + cs.misses;
+        json out = {
+            {"ok", true},
+            {"llm", {
+                {"workers", st.workers},
+                {"running", st.running},
+                {"queued", st.queued},
+                {"capacity", st.capacity},
+                {"jobs", st.jobs},
+                {"completed", st.completed},
+                {"failed", st.failed},
+                {"rejected", st.rejected},
+                {"coalesced", st.coalesced}
+            }},
+            {"cache", {
+                {"hits", cs.hits},
+                {"diskHits", cs.diskHits},
+                {"misses", cs.misses},
+                {"hitRate", lookups ? (double)cs.hits / (double)lookups : 0.0},
+                {"evictions", cs.evictions},
+                {"entries", cs.entries},
+                {"diskEntries", cs.diskEntries}
+            }},
+            {"http", {
+                {"threads", httpThreads},
+                {"waiters", WAITERS.load()},
+                {"maxWaiters", MAX_WAITERS}
+            }}
+        };
+        res.set_content(out.dump(), "application/json");
         });
 
     svr.Post("/analysis", [](const httplib::Request& req, httplib::Response& res) {
@@ -268,6 +454,8 @@ int main() {
         areq.results = body.value("results", json::object());
         areq.problemId = body.value("problemId", "");
 
+        const trace::Context ctx = trace::request_context(req);
+        trace::Span rules("rules", ctx);
         AnalysisResult ar;
         if (areq.problemId == "two-sum") {
             ar = analyze_two_sum(areq);
@@ -285,40 +473,139 @@ int main() {
                 "O(?)"
             };
         }
+        rules.end();
+        {
+            trace::Span sc("static_complexity", ctx);
+            apply_static_complexity(areq, ar);
+            sc.attr("estimate", ar.complexityEstimate);
+        }
+        {
+            trace::Span mh("memory_hints", ctx);
+            apply_memory_hints(areq, ar);
+        }
 
-        // Llamar al servicio LLM y agregar su feedback a las pistas
-        std::string llm_text = call_llm_via_proxy(areq);
-
-        // Encabezado fijo
-        ar.hints.push_back("Sugerencia generada por IA:");
-
-        // Dividir la respuesta de la IA en líneas y agregar cada una como hint aparte
-        std::stringstream ss(llm_text);
-        std::string line;
-
-        while (std::getline(ss, line)) {
-            // Quitar espacios en blanco al inicio y fin (trim sencillo)
-            auto start = line.find_first_not_of(" \t\r\n");
-            auto end = line.find_last_not_of(" \t\r\n");
-
-            if (start == std::string::npos) continue; // línea vacía
-
-            std::string cleaned = line.substr(start, end - start + 1);
-
-            if (!cleaned.empty()) {
-                ar.hints.push_back(cleaned);
-            }
+        // La IA se consulta en segundo plano: se responde ya con las pistas
+        // por reglas y el cliente sigue el trabajo en /analysis/jobs/{id}
+        json llm;
+        trace::Span pb("prompt_build", ctx);
+        std::string key = AnalysisCache::make_key(areq.problemId, areq.source, areq.results);
+        std::string prompt = build_llm_prompt(areq);
+        pb.attr("bytes", (int64_t)prompt.size()).end();
+
+        trace::Span submit("llm.submit", ctx);
+        std::string jobId = LLM.submit(std::move(prompt), areq.problemId, key, ctx);
+        submit.end();
+        if (!jobId.empty()) {
+            LLM.wait_read(jobId, 0, std::chrono::milliseconds(0), [&](const LlmJobs::Job& j) {
+                llm = { {"jobId", jobId}, {"status", j.status}, {"cached", j.cached} };
+                });
+        }
+        else {
+            llm = { {"status", "unavailable"},
+                {"error", "La IA está atendiendo demasiadas peticiones, intenta de nuevo en unos segundos."} };
         }
 
         json out = {
             {"hints", ar.hints},
             {"probablePatterns", ar.probablePatterns},
-            {"complexityEstimate", ar.complexityEstimate}
+            {"complexityEstimate", ar.complexityEstimate},
+            {"llm", llm}
         };
 
         res.set_content(out.dump(), "application/json");
         });
 
+    // Estado del trabajo de la IA. Long-poll: ?since=<version>&wait=<ms>
+    svr.Get(R"(/analysis/jobs/([0-9a-f]+))", [maxWaitMs](const httplib::Request& req, httplib::Response& res) {
+        set_cors(res);
+        auto id = req.matches[1].str();
+
+        uint64_t since = 0;
+        long long waitMs = 0;
+        try {
+            if (req.has_param("since")) since = std::stoull(req.get_param_value("since"));
+            if (req.has_param("wait")) waitMs = std::stoll(req.get_param_value("wait"));
+        }
+        catch (...) {
+            res.status = 400;
+            res.set_content(R"({"error":"invalid params"})", "application/json");
+            return;
+        }
+        waitMs = std::clamp<long long>(waitMs, 0, (long long)maxWaitMs);
+        // Sin hilo de espera disponible se contesta con el estado actual
+        const bool waiting = waitMs > 0 && acquire_waiter();
+        if (!waiting) waitMs = 0;
+
+        json out;
+        bool found = LLM.wait_read(id, since, std::chrono::milliseconds(waitMs), [&](const LlmJobs::Job& j) {
+            out = { {"status", j.status}, {"version", j.version}, {"lines", j.lines}, {"cached", j.cached} };
+            if (!j.error.empty()) out["error"] = j.error;
+            });
+        if (waiting) release_waiter();
+        if (!found) {
+            res.status = 404;
+            res.set_content(R"({"error":"not found"})", "application/json");
+            return;
+        }
+        res.set_content(out.dump(), "application/json");
+        });
+
+    // Stream SSE: un evento "line" por cada línea de la IA según llega y un
+    // evento "end" con el estado final; luego se cierra
+    svr.Get(R"(/analysis/jobs/([0-9a-f]+)/events)", [](const httplib::Request& req, httplib::Response& res) {
+        set_cors(res);
+        auto id = req.matches[1].str();
+        if (!LLM.wait_read(id, 0, std::chrono::milliseconds(0), [](const LlmJobs::Job&) {})) {
+            res.status = 404;
+            res.set_content(R"({"error":"not found"})", "application/json");
+            return;
+        }
+        if (!acquire_waiter()) {
+            res.status = 503;
+            res.set_header("Retry-After", "2");
+            res.set_content(R"({"error":"too many streams, use long-poll"})", "application/json");
+            return;
+        }
+
+        struct StreamState {
+            uint64_t version = 0;     // versión ya vista
+            size_t lines = 0;         // líneas ya enviadas
+            bool finished = false;
+        };
+        auto st = std::make_shared<StreamState>();
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no");
+        res.set_chunked_content_provider("text/event-stream",
+            [id, st](size_t, httplib::DataSink& sink) {
+                if (st->finished) {
+                    sink.done();
+                    return true;
+                }
+                std::string event;
+                bool found = LLM.wait_read(id, st->version, std::chrono::milliseconds(15000),
+                    [&](const LlmJobs::Job& j) {
+                        st->version = j.version;
+                        for (; st->lines < j.lines.size(); ++st->lines) {
+                            event += "id: " + std::to_string(st->lines + 1) + "\nevent: line\ndata: "
+                                + json(j.lines[st->lines]).dump() + "\n\n";
+                        }
+                        if (j.status == "done" || j.status == "error") {
+                            json end = { {"status", j.status}, {"cached", j.cached} };
+                            if (!j.error.empty()) end["error"] = j.error;
+                            event += "event: end\ndata: " + end.dump() + "\n\n";
+                            st->finished = true;
+                        }
+                    });
+                if (!found) {
+                    sink.done();
+                    return true;
+                }
+                if (event.empty()) event = ": ping\n\n";   // mantiene viva la conexión
+                return sink.write(event.data(), event.size());
+            },
+            [](bool) { release_waiter(); });
+        });
+
     std::cout << "[ANA] Analyzer escuchando en http://localhost:8083\n";
     if (!svr.listen("0.0.0.0", 8083)) {
         std::cerr << "No se pudo abrir el puerto 8083\n";
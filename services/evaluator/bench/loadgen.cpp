@@ -0,0 +1,366 @@
+// Generador de carga para el Evaluator.
+//
+// Reproduce un corpus de envíos (correctos, con error de compilación, TLE y
+// reenvíos idénticos) sobre los cuatro problemas internos contra
+// POST /submissions, espera cada resultado con long-poll y reporta
+// throughput, percentiles de latencia extremo a extremo y el desglose
+// cola / compilación / ejecución.
+//
+// Uso:
+//   evaluator_loadgen [--host localhost] [--port 8082] [--clients 8]
+//                     [--requests 200] [--mix correct=50,ce=15,tle=10,resubmit=25]
+//                     [--seed 1] [--timeout-s 120] [--json salida.json]
+//
+// Sale con código 1 si hubo errores o veredictos inesperados.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include "httplib.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+// ============================ CORPUS ===========================
+struct ProblemSources {
+    std::string id;
+    std::string correct;
+    std::string compileError;
+    std::string tle;
+};
+
+static const std::vector<ProblemSources> CORPUS = {
+    { "two-sum",
+      "class Solution { public: vector<int> twoSum(vector<int>& n, int t) {\n"
+      "    unordered_map<int,int> m;\n"
+      "    for (int i = 0; i < (int)n.size(); ++i) {\n"
+      "        auto it = m.find(t - n[i]);\n"
+      "        if (it != m.end()) return { it->second, i };\n"
+      "        m[n[i]] = i;\n"
+      "    }\n"
+      "    return {};\n"
+      "} };\n",
+      "class Solution { public: vector<int> twoSum(vector<int>& n, int t) { return resultado; } };\n",
+      "class Solution { public: vector<int> twoSum(vector<int>& n, int t) {\n"
+      "    volatile long x = 0; while (true) ++x; return {};\n"
+      "} };\n" },
+    { "reverse-string",
+      "class Solution { public: void reverseString(vector<char>& s) {\n"
+      "    int i = 0, j = (int)s.size() - 1;\n"
+      "    while (i < j) swap(s[i++], s[j--]);\n"
+      "} };\n",
+      "class Solution { public: void reverseString(vector<char>& s) { reverse(s.begin(), s.end()) } };\n",
+      "class Solution { public: void reverseString(vector<char>& s) {\n"
+      "    volatile long x = 0; while (true) ++x;\n"
+      "} };\n" },
+    { "binary-search",
+      "class Solution { public: int search(vector<int>& a, int t) {\n"
+      "    int l = 0, r = (int)a.size() - 1;\n"
+      "    while (l <= r) {\n"
+      "        int m = l + (r - l) / 2;\n"
+      "        if (a[m] == t) return m;\n"
+      "        if (a[m] < t) l = m + 1; else r = m - 1;\n"
+      "    }\n"
+      "    return -1;\n"
+      "} };\n",
+      "class Solution { public: int search(vector<int>& a, int t) { return a.find(t); } };\n",
+      "class Solution { public: int search(vector<int>& a, int t) {\n"
+      "    volatile long x = 0; while (true) ++x; return -1;\n"
+      "} };\n" },
+    { "count-negatives",
+      "class Solution { public: int solve(vector<int>& a) {\n"
+      "    int c = 0;\n"
+      "    for (int x : a) if (x < 0) ++c;\n"
+      "    return c;\n"
+      "} };\n",
+      "class Solution { public: int solve(vector<int>& a) { int c = 0; for (x : a) c++; return c; } };\n",
+      "class Solution { public: int solve(vector<int>& a) {\n"
+      "    volatile long x = 0; while (true) ++x; return 0;\n"
+      "} };\n" },
+};
+
+enum Kind { CORRECT, COMPILE_ERROR, TLE, RESUBMIT, KIND_COUNT };
+static const char* KIND_NAMES[KIND_COUNT] = { "correct", "ce", "tle", "resubmit" };
+static const char* KIND_VERDICT[KIND_COUNT] = { "AC", "CE", "TLE", "AC" };
+
+// =========================== OPCIONES ==========================
+struct Options {
+    std::string host = "localhost";
+    int port = 8082;
+    size_t clients = 8;
+    size_t requests = 200;
+    int weights[KIND_COUNT] = { 50, 15, 10, 25 };
+    unsigned seed = 1;
+    int timeoutS = 120;
+    std::string jsonOut;
+};
+
+static bool parse_mix(const std::string& text, Options& o) {
+    for (int k = 0; k < KIND_COUNT; ++k) o.weights[k] = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = item.substr(0, eq);
+        int k = 0;
+        while (k < KIND_COUNT && name != KIND_NAMES[k]) ++k;
+        if (k == KIND_COUNT) return false;
+        o.weights[k] = std::atoi(item.c_str() + eq + 1);
+        pos = end + 1;
+    }
+    return std::accumulate(o.weights, o.weights + KIND_COUNT, 0) > 0;
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string v = argv[++i];
+        if (a == "--host") o.host = v;
+        else if (a == "--port") o.port = std::atoi(v.c_str());
+        else if (a == "--clients") o.clients = (size_t)std::max(1, std::atoi(v.c_str()));
+        else if (a == "--requests") o.requests = (size_t)std::max(1, std::atoi(v.c_str()));
+        else if (a == "--mix") { if (!parse_mix(v, o)) return false; }
+        else if (a == "--seed") o.seed = (unsigned)std::strtoul(v.c_str(), nullptr, 10);
+        else if (a == "--timeout-s") o.timeoutS = std::atoi(v.c_str());
+        else if (a == "--json") o.jsonOut = v;
+        else return false;
+    }
+    return true;
+}
+
+// ========================== RESULTADOS =========================
+struct Sample {
+    Kind kind = CORRECT;
+    std::string problemId;
+    bool ok = false;            // llegó a "done"
+    std::string error;
+    std::string verdict;
+    double e2eMs = 0;           // POST -> done visto por el cliente
+    int queueMs = 0;
+    int compileMs = 0;
+    int runMs = 0;
+    bool cached = false;
+    int rejected = 0;           // respuestas 503 antes de ser aceptado
+};
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)v.size());
+    return v[std::min(v.size() - 1, rank ? rank - 1 : 0)];
+}
+
+// Envía una submission y espera su resultado
+static Sample run_one(const Options& o, Kind kind, const ProblemSources& p, const std::string& nonce) {
+    Sample s;
+    s.kind = kind;
+    s.problemId = p.id;
+
+    std::string src;
+    switch (kind) {
+    case CORRECT: src = p.correct; break;
+    case COMPILE_ERROR: src = p.compileError; break;
+    case TLE: src = p.tle; break;
+    default: src = p.correct; break;
+    }
+    // Un comentario único evita la caché de compilación; el reenvío va idéntico
+    if (kind != RESUBMIT) src += "// loadgen " + nonce + "\n";
+
+    httplib::Client cli(o.host, o.port);
+    cli.set_connection_timeout(5, 0);
+    cli.set_read_timeout(30, 0);
+
+    json body = { {"problemId", p.id}, {"lang", "cpp"}, {"source", src} };
+    const auto t0 = Clock::now();
+    const auto deadline = t0 + std::chrono::seconds(o.timeoutS);
+
+    std::string id;
+    while (id.empty()) {
+        auto res = cli.Post("/submissions", body.dump(), "application/json");
+        if (!res) {
+            s.error = "POST sin respuesta";
+            return s;
+        }
+        if (res->status == 503) {
+            ++s.rejected;
+            int wait = std::max(1, std::atoi(res->get_header_value("Retry-After").c_str()));
+            if (Clock::now() + std::chrono::seconds(wait) > deadline) {
+                s.error = "cola llena hasta el timeout";
+                return s;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(wait));
+            continue;
+        }
+        auto j = json::parse(res->body, nullptr, false);
+        if (res->status != 200 || j.is_discarded() || !j.contains("submissionId")) {
+            s.error = "POST HTTP " + std::to_string(res->status);
+            return s;
+        }
+        id = j["submissionId"].get<std::string>();
+    }
+
+    uint64_t version = 0;
+    while (Clock::now() < deadline) {
+        std::string path = "/submissions/" + id + "?since=" + std::to_string(version) + "&wait=10000";
+        auto res = cli.Get(path);
+        if (!res || res->status != 200) {
+            s.error = res ? "GET HTTP " + std::to_string(res->status) : "GET sin respuesta";
+            return s;
+        }
+        auto j = json::parse(res->body, nullptr, false);
+        if (j.is_discarded()) {
+            s.error = "respuesta inválida";
+            return s;
+        }
+        version = j.value("version", version);
+        if (j.value("status", "") != "done") continue;
+
+        s.e2eMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        s.ok = true;
+        s.verdict = j.value("verdict", "");
+        s.queueMs = j.value("queueMs", 0);
+        s.compileMs = j.value("compileMs", 0);
+        s.runMs = j.value("wallMs", 0);
+        s.cached = j.value("cached", false);
+        return s;
+    }
+    s.error = "timeout esperando el resultado";
+    return s;
+}
+
+// ============================ REPORTE ==========================
+static json summarize(const std::vector<const Sample*>& ss) {
+    std::vector<double> e2e;
+    double queue = 0, compile = 0, run = 0;
+    size_t ok = 0, cached = 0, mismatches = 0, errors = 0, rejected = 0;
+    for (const Sample* s : ss) {
+        rejected += (size_t)s->rejected;
+        if (!s->ok) {
+            ++errors;
+            continue;
+        }
+        ++ok;
+        e2e.push_back(s->e2eMs);
+        queue += s->queueMs;
+        compile += s->compileMs;
+        run += s->runMs;
+        if (s->cached) ++cached;
+        if (s->verdict != KIND_VERDICT[s->kind]) ++mismatches;
+    }
+    double n = ok ? (double)ok : 1.0;
+    return {
+        {"count", ss.size()}, {"ok", ok}, {"errors", errors}, {"rejected503", rejected},
+        {"verdictMismatches", mismatches},
+        {"p50Ms", percentile(e2e, 50)}, {"p95Ms", percentile(e2e, 95)},
+        {"p99Ms", percentile(e2e, 99)}, {"maxMs", e2e.empty() ? 0.0 : *std::max_element(e2e.begin(), e2e.end())},
+        {"avgQueueMs", queue / n}, {"avgCompileMs", compile / n}, {"avgRunMs", run / n},
+        {"cacheHitRate", (double)cached / n}
+    };
+}
+
+static void print_row(const std::string& name, const json& r) {
+    std::printf("%-10s %6zu %6zu %8.0f %8.0f %8.0f %8.0f %8.0f %8.0f %8.0f %6.0f%% %5zu\n",
+        name.c_str(), r["count"].get<size_t>(), r["errors"].get<size_t>(),
+        r["p50Ms"].get<double>(), r["p95Ms"].get<double>(), r["p99Ms"].get<double>(),
+        r["maxMs"].get<double>(), r["avgQueueMs"].get<double>(), r["avgCompileMs"].get<double>(),
+        r["avgRunMs"].get<double>(), 100.0 * r["cacheHitRate"].get<double>(),
+        r["verdictMismatches"].get<size_t>());
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse_args(argc, argv, o)) {
+        std::fprintf(stderr,
+            "uso: %s [--host H] [--port P] [--clients N] [--requests N]\n"
+            "          [--mix correct=50,ce=15,tle=10,resubmit=25] [--seed S]\n"
+            "          [--timeout-s S] [--json fichero]\n", argv[0]);
+        return 2;
+    }
+
+    // El plan se genera por adelantado para que una semilla dé siempre la misma carga
+    std::mt19937 rng(o.seed);
+    std::discrete_distribution<int> pickKind(o.weights, o.weights + KIND_COUNT);
+    std::uniform_int_distribution<size_t> pickProblem(0, CORPUS.size() - 1);
+    std::vector<std::pair<Kind, size_t>> plan(o.requests);
+    for (auto& step : plan) step = { (Kind)pickKind(rng), pickProblem(rng) };
+
+    const std::string runTag = std::to_string(
+        std::chrono::system_clock::now().time_since_epoch().count());
+
+    std::printf("[LG] %zu envíos con %zu clientes contra %s:%d\n",
+        o.requests, o.clients, o.host.c_str(), o.port);
+
+    std::vector<Sample> samples(o.requests);
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> done{ 0 };
+    const auto t0 = Clock::now();
+
+    auto client = [&]() {
+        for (;;) {
+            size_t i = next.fetch_add(1);
+            if (i >= plan.size()) return;
+            samples[i] = run_one(o, plan[i].first, CORPUS[plan[i].second],
+                runTag + "-" + std::to_string(i));
+            size_t d = done.fetch_add(1) + 1;
+            if (d % 50 == 0) std::printf("[LG] %zu/%zu\n", d, plan.size());
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < o.clients; ++c) threads.emplace_back(client);
+    for (auto& t : threads) t.join();
+    const double elapsedS = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    // Agregados por tipo de envío, por problema y global
+    std::map<std::string, std::vector<const Sample*>> byKind, byProblem;
+    std::vector<const Sample*> all;
+    for (const auto& s : samples) {
+        byKind[KIND_NAMES[s.kind]].push_back(&s);
+        byProblem[s.problemId].push_back(&s);
+        all.push_back(&s);
+    }
+
+    json report = summarize(all);
+    report["elapsedS"] = elapsedS;
+    report["throughput"] = (double)report["ok"].get<size_t>() / elapsedS;
+    report["clients"] = o.clients;
+    for (const auto& [k, v] : byKind) report["byKind"][k] = summarize(v);
+    for (const auto& [k, v] : byProblem) report["byProblem"][k] = summarize(v);
+
+    std::printf("\n%-10s %6s %6s %8s %8s %8s %8s %8s %8s %8s %7s %5s\n",
+        "tipo", "n", "err", "p50", "p95", "p99", "max", "cola", "compil", "ejec", "caché", "≠ver");
+    for (const auto& [k, v] : report["byKind"].items()) print_row(k, v);
+    print_row("total", report);
+    std::printf("\n[LG] %.1f s, %.2f envíos/s, %zu respuestas 503\n",
+        elapsedS, report["throughput"].get<double>(), report["rejected503"].get<size_t>());
+
+    for (const auto& s : samples) {
+        if (!s.error.empty()) {
+            std::printf("[LG] Primer error: %s (%s)\n", s.error.c_str(), s.problemId.c_str());
+            break;
+        }
+    }
+
+    if (!o.jsonOut.empty()) {
+        std::ofstream f(o.jsonOut);
+        f << report.dump(2) << "\n";
+    }
+
+    bool clean = report["errors"].get<size_t>() == 0 && report["verdictMismatches"].get<size_t>() == 0;
+    return clean ? 0 : 1;
+}
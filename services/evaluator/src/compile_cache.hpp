@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "hash128.hpp"
+
+// ======================= COMPILE CACHE =========================
+// Caché en disco, direccionada por contenido, de binarios compilados y de
+// errores de compilación. La clave es un hash de todo lo que influye en el
+// resultado (código del estudiante, harness, compilador y flags). El tamaño
+// total está acotado y se expulsa por LRU.
+class CompileCache {
+public:
+    struct Entry {
+        bool ok = false;        // true: hay binario; false: error de compilación
+        std::string errors;     // salida del compilador si !ok
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+        uint64_t maxBytes = 0;
+    };
+
+    // Hash de 128 bits en hex (ver hash128.hpp); cada parte va precedida de su longitud
+    static std::string key(std::initializer_list<std::string_view> parts) {
+        hash128::Hasher h;
+        for (auto part : parts) h.part(part);
+        return h.hex();
+    }
+
+    void init(const std::filesystem::path& dir, uint64_t maxBytes) {
+        std::lock_guard<std::mutex> lk(m_);
+        dir_ = dir;
+        maxBytes_ = maxBytes;
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+
+        // Reconstruir el índice con lo que haya quedado de ejecuciones previas,
+        // del más antiguo al más reciente según la fecha de modificación.
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> found;
+        for (auto it = std::filesystem::directory_iterator(dir_, ec);
+            !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            auto ext = it->path().extension();
+            if (ext == ".tmp") {
+                std::filesystem::remove(it->path(), ec);
+                continue;
+            }
+            if (ext != ".bin" && ext != ".err") continue;
+            found.emplace_back(it->last_write_time(ec), it->path());
+        }
+        std::sort(found.begin(), found.end());
+        for (const auto& [t, p] : found) {
+            (void)t;
+            add_locked(p.stem().string(), p.extension() == ".bin", file_size(p));
+        }
+        evict_locked();
+    }
+
+    bool enabled() const { return !dir_.empty() && maxBytes_ > 0; }
+
+    // Busca la clave. Si hay binario, lo enlaza (o copia) en `exeOut`.
+    std::optional<Entry> lookup(const std::string& k, const std::filesystem::path& exeOut) {
+        if (!enabled()) return std::nullopt;
+        std::lock_guard<std::mutex> lk(m_);
+        auto it = index_.find(k);
+        if (it == index_.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        Entry e;
+        e.ok = it->second.ok;
+        std::error_code ec;
+        if (e.ok) {
+            // Hard link dentro del lock: una expulsión posterior no afecta al enlace
+            std::filesystem::remove(exeOut, ec);
+            std::filesystem::create_hard_link(path_for(k, true), exeOut, ec);
+            if (ec) {
+                ec.clear();
+                std::filesystem::copy_file(path_for(k, true), exeOut,
+                    std::filesystem::copy_options::overwrite_existing, ec);
+            }
+        }
+        else {
+            e.errors = read_all(path_for(k, false));
+        }
+        if (ec) {
+            drop_locked(it);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        lru_.splice(lru_.end(), lru_, it->second.pos);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return e;
+    }
+
+    void store_binary(const std::string& k, const std::filesystem::path& exe) {
+        if (!enabled()) return;
+        std::error_code ec;
+        auto tmp = tmp_path(k);
+        std::filesystem::copy_file(exe, tmp, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) return;
+        commit(k, true, tmp);
+    }
+
+    void store_error(const std::string& k, const std::string& errors) {
+        if (!enabled()) return;
+        auto tmp = tmp_path(k);
+        {
+            std::ofstream f(tmp, std::ios::binary);
+            f << errors;
+            if (!f) return;
+        }
+        commit(k, false, tmp);
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.evictions = evictions_;
+        s.entries = index_.size();
+        s.bytes = bytes_;
+        s.maxBytes = maxBytes_;
+        return s;
+    }
+
+private:
+    struct Node {
+        bool ok;
+        uint64_t size;
+        std::list<std::string>::iterator pos;
+    };
+
+    static uint64_t file_size(const std::filesystem::path& p) {
+        std::error_code ec;
+        auto n = std::filesystem::file_size(p, ec);
+        return ec ? 0 : (uint64_t)n;
+    }
+
+    static std::string read_all(const std::filesystem::path& p) {
+        std::ifstream f(p, std::ios::binary);
+        std::ostringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    std::filesystem::path path_for(const std::string& k, bool ok) const {
+        return dir_ / (k + (ok ? ".bin" : ".err"));
+    }
+
+    // Nombre temporal único: dos workers pueden guardar la misma clave a la vez
+    std::filesystem::path tmp_path(const std::string& k) {
+        return dir_ / (k + "." + std::to_string(seq_.fetch_add(1)) + ".tmp");
+    }
+
+    void commit(const std::string& k, bool ok, const std::filesystem::path& tmp) {
+        std::error_code ec;
+        std::lock_guard<std::mutex> lk(m_);
+        auto it = index_.find(k);
+        if (it != index_.end()) drop_locked(it);
+        std::filesystem::rename(tmp, path_for(k, ok), ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+        add_locked(k, ok, file_size(path_for(k, ok)));
+        evict_locked();
+    }
+
+    void add_locked(const std::string& k, bool ok, uint64_t size) {
+        auto old = index_.find(k);
+        if (old != index_.end()) {
+            bytes_ -= old->second.size;
+            lru_.erase(old->second.pos);
+            index_.erase(old);
+        }
+        lru_.push_back(k);
+        index_[k] = Node{ ok, size, std::prev(lru_.end()) };
+        bytes_ += size;
+    }
+
+    void drop_locked(std::unordered_map<std::string, Node>::iterator it) {
+        std::error_code ec;
+        std::filesystem::remove(path_for(it->first, it->second.ok), ec);
+        bytes_ -= it->second.size;
+        lru_.erase(it->second.pos);
+        index_.erase(it);
+    }
+
+    void evict_locked() {
+        while (bytes_ > maxBytes_ && !lru_.empty()) {
+            drop_locked(index_.find(lru_.front()));
+            ++evictions_;
+        }
+    }
+
+    mutable std::mutex m_;
+    std::filesystem::path dir_;
+    uint64_t maxBytes_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t evictions_ = 0;
+    std::list<std::string> lru_;                    // frente = menos usado
+    std::unordered_map<std::string, Node> index_;
+    std::atomic<uint64_t> hits_{ 0 };
+    std::atomic<uint64_t> misses_{ 0 };
+    std::atomic<uint64_t> seq_{ 0 };
+};
@@ -0,0 +1,469 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+// ===================== GENERADOR DE HARNESS ====================
+// A partir de la firma tipada de Solution::<método> genera:
+//  - el driver: main() que lee los casos de stdin en formato compacto,
+//    llama a la solución y escribe cada resultado como JSON en una línea
+//    que empieza por el byte 0x1e, para distinguirla de lo que imprima el
+//    estudiante (ver output_checker.hpp);
+//  - el adapter: función con enlace externo que envuelve a Solution.
+// El driver reemplaza además operator new/delete para contar lo que reserva
+// cada llamada a la solución: tras ella escribe en stderr una línea que
+// empieza por 0x1f con "<reservas> <bytes> <pico de bytes vivos>". Si una
+// reserva falla (RLIMIT_AS) deja además en stderr la marca ALLOC_FAILED antes
+// de lanzar bad_alloc, para que el veredicto sea MLE aunque luego se caiga
+// de otra forma (bad_alloc capturado y un SIGSEGV después, por ejemplo).
+// También codifica los tests ("in" en JSON) al formato que lee el driver.
+//
+// Formato de entrada (tokens separados por espacios):
+//   T                      número de casos
+//   int/long long/double   el número tal cual
+//   bool / char            entero (0/1, código del carácter)
+//   string                 longitud, un espacio y los bytes crudos
+//   vector<T>              tamaño y luego cada elemento
+//
+// Con T negativo el driver entra en modo medición (ver scaling.hpp): lee un
+// único caso y llama a la solución repetidamente durante -T ms sobre copias
+// de la entrada; imprime "<mejor tiempo en ns> <repeticiones>". Solo se
+// cronometra la llamada, no la lectura ni el arranque del proceso.
+
+namespace harness_gen {
+
+struct Type {
+    enum Kind { Int, Long, Double, Bool, Char, String, Vector };
+    Kind kind = Int;
+    std::shared_ptr<Type> elem;   // solo para Vector
+    // Cómo lo escribió la firma cuando no es el nombre canónico ("long",
+    // "int64_t", "float"): el adapter tiene que declarar el mismo tipo para
+    // que la referencia se pueda ligar al parámetro de la solución
+    std::string spelling;
+
+    std::string cpp() const {
+        if (!spelling.empty()) return spelling;
+        switch (kind) {
+        case Int: return "int";
+        case Long: return "long long";
+        case Double: return "double";
+        case Bool: return "bool";
+        case Char: return "char";
+        case String: return "string";
+        case Vector: return "vector<" + elem->cpp() + ">";
+        }
+        return "";
+    }
+};
+
+struct Param {
+    std::string name;
+    Type type;
+};
+
+struct Signature {
+    std::string method;
+    bool returnsVoid = false;
+    Type returns;
+    std::vector<Param> params;
+    size_t output = 0;   // índice del parámetro que se imprime si returnsVoid
+};
+
+inline std::string strip_spaces(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c != ' ' && c != '\t') out += c;
+    }
+    return out;
+}
+
+inline bool is_identifier(const std::string& s) {
+    if (s.empty() || std::isdigit((unsigned char)s[0])) return false;
+    for (char c : s) {
+        if (!std::isalnum((unsigned char)c) && c != '_') return false;
+    }
+    return true;
+}
+
+// Acepta "int", "long long", "long", "int64_t", "double", "float", "bool",
+// "char", "string", "vector<...>" (anidable), con o sin "std::".
+inline Type parse_type(const std::string& text) {
+    std::string t = strip_spaces(text);
+    auto drop_std = [](std::string& s) {
+        if (s.rfind("std::", 0) == 0) s = s.substr(5);
+    };
+    drop_std(t);
+
+    Type ty;
+    if (t == "int") ty.kind = Type::Int;
+    else if (t == "longlong") ty.kind = Type::Long;
+    else if (t == "long" || t == "int64_t") {
+        ty.kind = Type::Long;
+        ty.spelling = t;
+    }
+    else if (t == "double") ty.kind = Type::Double;
+    else if (t == "float") {
+        ty.kind = Type::Double;
+        ty.spelling = t;
+    }
+    else if (t == "bool") ty.kind = Type::Bool;
+    else if (t == "char") ty.kind = Type::Char;
+    else if (t == "string") ty.kind = Type::String;
+    else if (t.rfind("vector<", 0) == 0 && t.back() == '>') {
+        ty.kind = Type::Vector;
+        ty.elem = std::make_shared<Type>(parse_type(t.substr(7, t.size() - 8)));
+    }
+    else {
+        throw std::runtime_error("tipo no soportado: " + text);
+    }
+    return ty;
+}
+
+// "signature": { "method", "returns", "params": [{name,type}], "output"? }
+inline Signature parse_signature(const nlohmann::json& j) {
+    Signature sig;
+    sig.method = j.value("method", "");
+    if (!is_identifier(sig.method)) throw std::runtime_error("firma sin 'method' válido");
+
+    std::string ret = strip_spaces(j.value("returns", "void"));
+    sig.returnsVoid = (ret == "void");
+    if (!sig.returnsVoid) sig.returns = parse_type(ret);
+
+    if (!j.contains("params") || !j["params"].is_array()) {
+        throw std::runtime_error("firma sin 'params'");
+    }
+    for (const auto& p : j["params"]) {
+        Param prm;
+        prm.name = p.value("name", "");
+        if (!is_identifier(prm.name)) throw std::runtime_error("parámetro con nombre inválido");
+        prm.type = parse_type(p.value("type", ""));
+        sig.params.push_back(std::move(prm));
+    }
+
+    if (sig.returnsVoid) {
+        std::string out = j.value("output", sig.params.empty() ? "" : sig.params[0].name);
+        bool found = false;
+        for (size_t i = 0; i < sig.params.size(); ++i) {
+            if (sig.params[i].name == out) { sig.output = i; found = true; }
+        }
+        if (!found) throw std::runtime_error("firma void sin parámetro de salida ('output')");
+    }
+    return sig;
+}
+
+// Texto canónico de la firma: sirve como clave de caché del driver
+inline std::string canonical(const Signature& sig) {
+    std::string s = sig.method + "(";
+    for (const auto& p : sig.params) s += p.type.cpp() + " " + p.name + ",";
+    s += ")->" + (sig.returnsVoid ? "void:" + sig.params[sig.output].name : sig.returns.cpp());
+    return s;
+}
+
+inline std::string entry_decl(const Signature& sig) {
+    std::string s = (sig.returnsVoid ? std::string("void") : sig.returns.cpp()) + " cc_entry(";
+    for (size_t i = 0; i < sig.params.size(); ++i) {
+        if (i) s += ", ";
+        s += sig.params[i].type.cpp() + "& " + sig.params[i].name;
+    }
+    return s + ")";
+}
+
+inline std::string make_adapter(const Signature& sig) {
+    std::string call = "sol." + sig.method + "(";
+    for (size_t i = 0; i < sig.params.size(); ++i) {
+        if (i) call += ", ";
+        call += sig.params[i].name;
+    }
+    call += ")";
+    return "\n" + entry_decl(sig) + " {\n    Solution sol;\n    "
+        + (sig.returnsVoid ? "" : "return ") + call + ";\n}\n";
+}
+
+// Lectura/escritura genérica compartida por todos los drivers
+static const char* DRIVER_RUNTIME = R"(
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+// Heap: cada bloque lleva delante su tamaño para descontarlo al liberarlo
+static atomic<long long> cc_allocs{ 0 }, cc_bytes{ 0 }, cc_live{ 0 }, cc_peak{ 0 };
+static void cc_alloc_failed() {
+    static atomic<bool> said{ false };
+    if (!said.exchange(true)) fputs("\x1d" "alloc-failed\n", stderr);   // stderr no reserva memoria
+}
+static void* cc_alloc(size_t n) {
+    void* p = malloc(n + 16);
+    if (!p) {
+        cc_alloc_failed();
+        throw bad_alloc();
+    }
+    *(size_t*)p = n;
+    cc_allocs.fetch_add(1, memory_order_relaxed);
+    cc_bytes.fetch_add((long long)n, memory_order_relaxed);
+    long long live = cc_live.fetch_add((long long)n, memory_order_relaxed) + (long long)n;
+    long long peak = cc_peak.load(memory_order_relaxed);
+    while (live > peak && !cc_peak.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+    return (char*)p + 16;
+}
+static void cc_free(void* p) {
+    if (!p) return;
+    char* b = (char*)p - 16;
+    cc_live.fetch_sub((long long)*(size_t*)b, memory_order_relaxed);
+    free(b);
+}
+static void* cc_alloc_nothrow(size_t n) noexcept {
+    try { return cc_alloc(n); } catch (...) { return nullptr; }
+}
+void* operator new(size_t n) { return cc_alloc(n); }
+void* operator new[](size_t n) { return cc_alloc(n); }
+void* operator new(size_t n, const nothrow_t&) noexcept { return cc_alloc_nothrow(n); }
+void* operator new[](size_t n, const nothrow_t&) noexcept { return cc_alloc_nothrow(n); }
+void operator delete(void* p) noexcept { cc_free(p); }
+void operator delete[](void* p) noexcept { cc_free(p); }
+void operator delete(void* p, size_t) noexcept { cc_free(p); }
+void operator delete[](void* p, size_t) noexcept { cc_free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { cc_free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { cc_free(p); }
+
+struct cc_heap_mark { long long allocs, bytes, live; };
+static cc_heap_mark cc_heap_begin() {
+    cc_peak.store(cc_live.load());
+    return { cc_allocs.load(), cc_bytes.load(), cc_live.load() };
+}
+static void cc_heap_report(const cc_heap_mark& m) {
+    const long long a = cc_allocs.load() - m.allocs, b = cc_bytes.load() - m.bytes;
+    const long long pk = cc_peak.load() - m.live;
+    cerr << '\x1f' << a << ' ' << b << ' ' << pk << '\n' << flush;
+}
+
+static void cc_read(int& x) { cin >> x; }
+static void cc_read(long& x) { cin >> x; }
+static void cc_read(long long& x) { cin >> x; }
+static void cc_read(float& x) { cin >> x; }
+static void cc_read(double& x) { cin >> x; }
+static void cc_read(bool& x) { int v = 0; cin >> v; x = v != 0; }
+static void cc_read(char& x) { int v = 0; cin >> v; x = (char)v; }
+static void cc_read(string& x) {
+    size_t n = 0; cin >> n; cin.get();
+    x.resize(n);
+    if (n) cin.read(&x[0], (streamsize)n);
+}
+template <class T> static void cc_read(vector<T>& v) {
+    size_t n = 0; cin >> n;
+    v.resize(n);
+    for (size_t i = 0; i < n; ++i) { T e; cc_read(e); v[i] = e; }
+}
+
+static void cc_write(int x) { cout << x; }
+static void cc_write(long x) { cout << x; }
+static void cc_write(long long x) { cout << x; }
+static void cc_write(bool x) { cout << (x ? "true" : "false"); }
+static void cc_write(double x) {
+    if (!std::isfinite(x)) { cout << "null"; return; }
+    char b[32]; snprintf(b, sizeof(b), "%.17g", x); cout << b;
+}
+static void cc_write(float x) {
+    if (!std::isfinite(x)) { cout << "null"; return; }
+    char b[32]; snprintf(b, sizeof(b), "%.9g", (double)x); cout << b;
+}
+static void cc_write(const string& s) {
+    static const char* HEX = "0123456789abcdef";
+    cout << '"';
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"': cout << "\\\""; break;
+        case '\\': cout << "\\\\"; break;
+        case '\b': cout << "\\b"; break;
+        case '\f': cout << "\\f"; break;
+        case '\n': cout << "\\n"; break;
+        case '\r': cout << "\\r"; break;
+        case '\t': cout << "\\t"; break;
+        default:
+            if (c < 0x20) cout << "\\u00" << HEX[c >> 4] << HEX[c & 15];
+            else cout << (char)c;
+        }
+    }
+    cout << '"';
+}
+static void cc_write(char c) { cc_write(string(1, c)); }
+template <class T> static void cc_write(const vector<T>& v) {
+    cout << '[';
+    for (size_t i = 0; i < v.size(); ++i) { if (i) cout << ','; cc_write(static_cast<const T&>(v[i])); }
+    cout << ']';
+}
+)";
+
+inline std::string make_driver(const Signature& sig) {
+    std::string d = DRIVER_RUNTIME;
+    d += "\n" + entry_decl(sig) + ";\n\n";
+    d += "int main() {\n"
+        "    ios::sync_with_stdio(false);\n"
+        "    cin.tie(nullptr);\n"
+        "    int cc_T = 0;\n"
+        "    if (!(cin >> cc_T)) return 0;\n";
+
+    std::string args, copies, copyArgs;
+    for (size_t i = 0; i < sig.params.size(); ++i) {
+        const std::string& n = sig.params[i].name;
+        if (i) {
+            args += ", ";
+            copyArgs += ", ";
+        }
+        args += n;
+        copyArgs += "cc_" + n;
+        copies += "            auto cc_" + n + " = " + n + ";\n";
+    }
+
+    // Modo medición
+    d += "    if (cc_T < 0) {\n";
+    for (const auto& p : sig.params) {
+        d += "        " + p.type.cpp() + " " + p.name + "{}; cc_read(" + p.name + ");\n";
+    }
+    d += "        const auto cc_budget = chrono::milliseconds(-(long long)cc_T);\n"
+        "        const auto cc_start = chrono::steady_clock::now();\n"
+        "        long long cc_best = -1;\n"
+        "        int cc_reps = 0;\n"
+        "        do {\n" + copies +
+        "            auto cc_t0 = chrono::steady_clock::now();\n"
+        "            " + std::string(sig.returnsVoid ? "" : "auto cc_res = ") + "cc_entry(" + copyArgs + ");\n"
+        "            long long cc_ns = (long long)chrono::duration_cast<chrono::nanoseconds>(\n"
+        "                chrono::steady_clock::now() - cc_t0).count();\n"
+        + std::string(sig.returnsVoid ? "" : "            (void)cc_res;\n") +
+        "            if (cc_best < 0 || cc_ns < cc_best) cc_best = cc_ns;\n"
+        "            ++cc_reps;\n"
+        "        } while (chrono::steady_clock::now() - cc_start < cc_budget && cc_reps < 1000);\n"
+        "        cout << cc_best << ' ' << cc_reps << '\\n' << flush;\n"
+        "        return 0;\n"
+        "    }\n\n";
+
+    d += "    for (int cc_t = 0; cc_t < cc_T; ++cc_t) {\n";
+    for (const auto& p : sig.params) {
+        d += "        " + p.type.cpp() + " " + p.name + "{}; cc_read(" + p.name + ");\n";
+    }
+    d += "        const cc_heap_mark cc_mark = cc_heap_begin();\n";
+    if (sig.returnsVoid) {
+        d += "        cc_entry(" + args + ");\n";
+        d += "        cc_heap_report(cc_mark);\n";
+        d += "        cout << '\\x1e';\n";
+        d += "        cc_write(" + sig.params[sig.output].name + ");\n";
+    }
+    else {
+        d += "        auto cc_res = cc_entry(" + args + ");\n";
+        d += "        cc_heap_report(cc_mark);\n";
+        d += "        cout << '\\x1e';\n";
+        d += "        cc_write(cc_res);\n";
+    }
+    d += "        cout << '\\n' << flush;\n"
+        "    }\n"
+        "    return 0;\n"
+        "}\n";
+    return d;
+}
+
+// ---------------- Codificación de los tests ----------------
+
+inline void encode_value(const nlohmann::json& v, const Type& t, std::string& out) {
+    auto fail = [&]() {
+        throw std::runtime_error("valor " + v.dump() + " no es de tipo " + t.cpp());
+    };
+    switch (t.kind) {
+    case Type::Int:
+    case Type::Long:
+        if (!v.is_number_integer()) fail();
+        out += std::to_string(v.get<long long>());
+        break;
+    case Type::Double: {
+        if (!v.is_number()) fail();
+        char b[32];
+        std::snprintf(b, sizeof(b), "%.17g", v.get<double>());
+        out += b;
+        break;
+    }
+    case Type::Bool:
+        if (!v.is_boolean()) fail();
+        out += v.get<bool>() ? "1" : "0";
+        break;
+    case Type::Char:
+        if (v.is_string() && v.get_ref<const std::string&>().size() == 1) {
+            out += std::to_string((int)(unsigned char)v.get_ref<const std::string&>()[0]);
+        }
+        else if (v.is_number_integer()) {
+            out += std::to_string(v.get<int>());
+        }
+        else {
+            fail();
+        }
+        break;
+    case Type::String: {
+        if (!v.is_string()) fail();
+        const auto& s = v.get_ref<const std::string&>();
+        out += std::to_string(s.size());
+        out += ' ';
+        out += s;
+        break;
+    }
+    case Type::Vector:
+        if (!v.is_array()) fail();
+        out += std::to_string(v.size());
+        for (const auto& e : v) {
+            out += ' ';
+            encode_value(e, *t.elem, out);
+        }
+        break;
+    }
+}
+
+// "in" puede ser un objeto {nombre: valor} o un arreglo posicional
+inline std::string encode_case(const Signature& sig, const nlohmann::json& in) {
+    std::string out;
+    for (size_t i = 0; i < sig.params.size(); ++i) {
+        const auto& p = sig.params[i];
+        const nlohmann::json* v = nullptr;
+        if (in.is_object() && in.contains(p.name)) v = &in[p.name];
+        else if (in.is_array() && i < in.size()) v = &in[i];
+        if (!v) throw std::runtime_error("falta el parámetro '" + p.name + "' en un test");
+        if (i) out += ' ';
+        encode_value(*v, p.type, out);
+    }
+    out += '\n';
+    return out;
+}
+
+// ---------------- Heap reportado por el driver ----------------
+
+// Marca que el driver escribe en stderr la primera vez que una reserva falla
+inline constexpr const char* ALLOC_FAILED = "\x1d" "alloc-failed";
+
+inline bool alloc_failed(const std::string& err) {
+    return err.find(ALLOC_FAILED) != std::string::npos;
+}
+
+struct HeapStats {
+    bool valid = false;
+    long long allocs = 0;      // llamadas a operator new durante la llamada
+    long long bytes = 0;       // bytes pedidos en total
+    long long peakBytes = 0;   // máximo de bytes vivos por encima de los de la entrada
+};
+
+// Extrae (y quita de `err`) la última línea 0x1f que escribió el driver
+inline HeapStats take_heap_stats(std::string& err) {
+    HeapStats h;
+    size_t at = err.rfind('\x1f');
+    if (at == std::string::npos) return h;
+    size_t end = err.find('\n', at);
+    if (end == std::string::npos) end = err.size();
+    const std::string line = err.substr(at + 1, end - at - 1);
+    err.erase(at, end < err.size() ? end + 1 - at : std::string::npos);
+    h.valid = std::sscanf(line.c_str(), "%lld %lld %lld", &h.allocs, &h.bytes, &h.peakBytes) == 3;
+    return h;
+}
+
+} // namespace harness_gen
@@ -11,9 +11,24 @@
 #include <cstdlib>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <csignal>
+#include <atomic>
+#include <optional>
+#include <map>
 
 #include "httplib.h"
 #include "json.hpp"
+#include "worker_pool.hpp"
+#include "compile_cache.hpp"
+#include "process.hpp"
+#include "harness_gen.hpp"
+#include "output_checker.hpp"
+#include "scaling.hpp"
+#include "submission_store.hpp"
+#include "workspace_pool.hpp"
+#include "http_metrics.hpp"
+#include "http_trace.hpp"
 
 using json = nlohmann::json;
 using namespace std::chrono_literals;
@@ -29,22 +44,23 @@ static std::string short_path(const std::string& p) {
 }
 #endif
 
-struct Submission {
-    std::string id;
-    std::string status;
-    json results = json::array();
-    int timeMs = 0;
-    int memoryKB = 256;
-    std::string errorMsg;
-};
-
-static std::unordered_map<std::string, Submission> DB;
-static std::mutex DBM;
+static SubmissionStore STORE;
 
 static void set_cors(httplib::Response& res) {
     res.set_header("Access-Control-Allow-Origin", "*");
     res.set_header("Access-Control-Allow-Methods", "GET,POST,OPTIONS");
-    res.set_header("Access-Control-Allow-Headers", "Content-Type");
+    res.set_header("Access-Control-Allow-Headers", "Content-Type, traceparent");
+    res.set_header("Access-Control-Expose-Headers", "Retry-After, traceresponse");
+}
+
+// Lee un entero positivo de una variable de entorno (o usa el valor por defecto)
+static size_t env_size(const char* name, size_t def) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return def;
+    char* end = nullptr;
+    unsigned long long n = std::strtoull(v, &end, 10);
+    if (end == v || n == 0) return def;
+    return (size_t)n;
 }
 
 static std::string rand_id(const std::string& pfx = "sub-") {
@@ -55,19 +71,14 @@ static std::string rand_id(const std::string& pfx = "sub-") {
     return s;
 }
 
-static std::string read_file(const fs::path& p) {
-    std::ifstream f(p, std::ios::binary);
-    std::ostringstream ss;
-    ss << f.rdbuf();
-    return ss.str();
-}
-
 static void write_file(const fs::path& p, const std::string& s) {
     std::ofstream f(p, std::ios::binary);
     f << s;
 }
 
-static std::string find_compiler() {
+// Primer compilador que responde a --version; su primera línea queda en `version`.
+// CC_EVAL_CXX fuerza uno concreto.
+static std::string find_compiler(std::string& version) {
 #ifdef _WIN32
     const char* CAND[] = {
         "C:\\\\Program Files\\\\LLVM\\\\bin\\\\clang++.exe",
@@ -75,254 +86,697 @@ static std::string find_compiler() {
         "clang++",
         "g++"
     };
-    for (auto c : CAND) {
-        std::string cmd = "\""; cmd += c; cmd += "\" --version >NUL 2>&1";
-        if (std::system(cmd.c_str()) == 0) return c;
-    }
-    return "";
 #else
-    if (std::system("clang++ --version >/dev/null 2>&1") == 0) return "clang++";
-    if (std::system("g++ --version >/dev/null 2>&1") == 0) return "g++";
-    return "";
+    const char* CAND[] = { "clang++", "g++" };
 #endif
+    std::vector<std::string> cands(std::begin(CAND), std::end(CAND));
+    if (const char* cxx = std::getenv("CC_EVAL_CXX"); cxx && *cxx) cands = { cxx };
+    for (const auto& c : cands) {
+        ProcSpec spec;
+        spec.argv = { c, "--version" };
+        ProcResult r = run_process(spec);
+        if (!r.ok()) continue;
+        version = r.out.substr(0, r.out.find('\n'));
+        return c;
+    }
+    return "";
 }
 
-// ======================= TWO SUM HARNESS =======================
-static std::string make_two_sum_harness() {
-    return R"(#include <iostream>
+// ======================= PRELUDE / PCH =========================
+// Cabecera común a todos los harness y al código del estudiante. Se compila
+// una sola vez como cabecera precompilada al arrancar el servicio.
+static const char* PRELUDE = R"(#pragma once
+#include <iostream>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <set>
+#include <queue>
+#include <stack>
+#include <deque>
 #include <algorithm>
+#include <numeric>
+#include <functional>
+#include <utility>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 using namespace std;
+)";
+
+// Perfiles de compilación. "fast" (-O0) compila en una fracción del tiempo y
+// basta para dar el veredicto; "perf" optimiza para la máquina y se usa en los
+// problemas que se califican por rendimiento ("profile": "perf") y al medir
+// complejidad. Cada perfil tiene su propio PCH y sus drivers precompilados.
+static const char* FAST_FLAGS = "-std=c++17 -O0";
+static const char* PERF_FLAGS = "-std=c++17 -O2 -march=native";
+
+static std::vector<std::string> split_flags(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream in(s);
+    for (std::string f; in >> f;) out.push_back(f);
+    return out;
+}
 
-#include "user.cpp"
+// Cada problema se parte en dos unidades de traducción, generadas a partir
+// de su firma (ver harness_gen.hpp):
+//  - driver:  main() que lee los casos de stdin; se compila a objeto una vez.
+//  - adapter: se añade tras "user.cpp" y expone Solution con enlace externo.
+// Así cada envío solo compila el código del estudiante y los tests viajan
+// como datos, sin recompilar nada.
+
+// ========================== PROBLEMAS ==========================
+struct TestCase {
+    std::string input;          // caso codificado para el driver
+    json expected;              // "out" del test
+    std::string expectedText;   // expected.dump(): lo que imprime el driver si acierta
+};
+
+struct ProblemDef {
+    std::string id;
+    harness_gen::Signature sig;
+    std::string sigKey;         // firma canónica (clave del driver precompilado)
+    std::string driver;
+    std::string adapter;
+    std::vector<TestCase> tests;
+    std::optional<scaling::Spec> scaling;   // "scaling" del problema, si lo trae
+    std::string profile;                    // perfil de compilación ("" = el por defecto)
+    OutputChecker::Spec check;              // cómo se compara la salida ("checker")
+};
 
-vector<int> twoSum(vector<int>& nums, int target) {
-    Solution sol;
-    return sol.twoSum(nums, target);
+// Definiciones de respaldo: se usan si el Problem Manager no responde o si
+// el problema guardado todavía no trae "signature".
+static const char* BUILTIN_PROBLEMS = R"json([
+  {
+    "id": "two-sum",
+    "signature": { "method": "twoSum", "returns": "vector<int>",
+                   "params": [ { "name": "nums", "type": "vector<int>" },
+                               { "name": "target", "type": "int" } ] },
+    "tests": [
+      { "in": { "nums": [2, 7, 11, 15], "target": 9 }, "out": [0, 1] },
+      { "in": { "nums": [3, 2, 4], "target": 6 }, "out": [1, 2] }
+    ],
+    "scaling": { "expected": "O(n)", "params": { "target": "absent" } }
+  },
+  {
+    "id": "reverse-string",
+    "signature": { "method": "reverseString", "returns": "void", "output": "s",
+                   "params": [ { "name": "s", "type": "vector<char>" } ] },
+    "tests": [
+      { "in": { "s": ["h", "e", "l", "l", "o"] }, "out": ["o", "l", "l", "e", "h"] },
+      { "in": { "s": ["H", "a", "n", "n", "a", "h"] }, "out": ["h", "a", "n", "n", "a", "H"] }
+    ],
+    "scaling": { "expected": "O(n)" }
+  },
+  {
+    "id": "binary-search",
+    "signature": { "method": "search", "returns": "int",
+                   "params": [ { "name": "nums", "type": "vector<int>" },
+                               { "name": "target", "type": "int" } ] },
+    "tests": [
+      { "in": { "nums": [-1, 0, 3, 5, 9, 12], "target": 9 }, "out": 4 },
+      { "in": { "nums": [-1, 0, 3, 5, 9, 12], "target": 2 }, "out": -1 },
+      { "in": { "nums": [1], "target": 1 }, "out": 0 },
+      { "in": { "nums": [1], "target": 2 }, "out": -1 }
+    ],
+    "scaling": { "expected": "O(log n)", "params": { "target": "absent" } }
+  },
+  {
+    "id": "count-negatives",
+    "signature": { "method": "solve", "returns": "int",
+                   "params": [ { "name": "nums", "type": "vector<int>" } ] },
+    "tests": [
+      { "in": { "nums": [-1, 2, -5, 7] }, "out": 2 },
+      { "in": { "nums": [-1, -2, -3] }, "out": 3 },
+      { "in": { "nums": [3, 4, 1] }, "out": 0 }
+    ],
+    "scaling": { "expected": "O(n)", "params": { "nums": "reversed" } }
+  }
+])json";
+
+static const json& builtin_problems() {
+    static const json B = json::parse(BUILTIN_PROBLEMS);
+    return B;
 }
 
-string to_str(const vector<int>& v) {
-    ostringstream ss; ss << "[";
-    for(size_t i = 0; i < v.size(); ++i) { 
-        if(i) ss << ","; 
-        ss << v[i]; 
+static const json* builtin_problem(const std::string& id) {
+    for (const auto& p : builtin_problems()) {
+        if (p.value("id", "") == id) return &p;
     }
-    ss << "]"; 
-    return ss.str();
+    return nullptr;
 }
 
-int main() {
-    // Caso 1
-    vector<int> nums1 = {2,7,11,15};
-    int target1 = 9;
-    auto result1 = twoSum(nums1, target1);
-    cout << to_str(result1) << endl;
-    
-    // Caso 2
-    vector<int> nums2 = {3,2,4};
-    int target2 = 6;
-    auto result2 = twoSum(nums2, target2);
-    cout << to_str(result2) << endl;
-    
-    return 0;
+// Construye la definición ejecutable (firma, harness y tests codificados).
+// Lanza std::runtime_error si la definición no es válida.
+static std::shared_ptr<const ProblemDef> build_problem(const std::string& id,
+    const json& signature, const json& tests, const json& scalingSpec = json(),
+    const std::string& profile = "", const json& checkerSpec = json()) {
+    auto p = std::make_shared<ProblemDef>();
+    p->id = id;
+    p->sig = harness_gen::parse_signature(signature);
+    p->sigKey = harness_gen::canonical(p->sig);
+    p->driver = harness_gen::make_driver(p->sig);
+    p->adapter = harness_gen::make_adapter(p->sig);
+
+    if (!tests.is_array() || tests.empty()) {
+        throw std::runtime_error("el problema no tiene tests");
+    }
+    for (const auto& t : tests) {
+        TestCase tc;
+        tc.input = harness_gen::encode_case(p->sig, t.contains("in") ? t["in"] : json());
+        tc.expected = t.contains("out") ? t["out"] : json();
+        tc.expectedText = tc.expected.dump();
+        p->tests.push_back(std::move(tc));
+    }
+    if (scalingSpec.is_object()) p->scaling = scaling::parse_spec(scalingSpec);
+    p->profile = profile;
+    p->check = OutputChecker::parse_spec(checkerSpec);
+    return p;
 }
-)";
+
+// Problem Manager (fuente de verdad de los tests) y caché con TTL por problema
+static std::string PM_HOST = "localhost";
+static int PM_PORT = 8084;
+static std::chrono::seconds PROBLEM_TTL{ 60 };
+
+static std::mutex PROBLEMS_M;
+static std::unordered_map<std::string,
+    std::pair<std::shared_ptr<const ProblemDef>, std::chrono::steady_clock::time_point>> PROBLEMS;
+
+// Devuelve la definición del problema o nullptr con el motivo en `err`.
+static std::shared_ptr<const ProblemDef> load_problem(const std::string& id, std::string& err,
+    const trace::Context& parent = {}) {
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lk(PROBLEMS_M);
+        auto it = PROBLEMS.find(id);
+        if (it != PROBLEMS.end() && now - it->second.second < PROBLEM_TTL) {
+            return it->second.first;
+        }
+    }
+
+    json remote;
+    httplib::Client cli(PM_HOST, PM_PORT);
+    cli.set_connection_timeout(2);
+    cli.set_read_timeout(5);
+    trace::Span span("pm.get_problem", parent);
+    span.attr("problemId", id);
+    httplib::Headers headers;
+    if (span.context().valid()) headers.emplace("traceparent", span.context().traceparent());
+    if (auto res = cli.Get(("/problems/" + id).c_str(), headers)) {
+        span.attr("http.status", res->status);
+        if (res->status == 200) {
+            remote = json::parse(res->body, nullptr, false);
+            if (remote.is_discarded()) remote = json();
+        }
+    }
+    span.end();
+
+    const json* builtin = builtin_problem(id);
+    json signature, tests, scalingSpec, checkerSpec;
+    std::string profile;
+    if (remote.is_object() && remote.contains("tests")) {
+        tests = remote["tests"];
+        if (remote.contains("profile") && remote["profile"].is_string()) profile = remote["profile"];
+        else if (builtin) profile = builtin->value("profile", "");
+        if (remote.contains("checker")) checkerSpec = remote["checker"];
+        else if (builtin) checkerSpec = builtin->value("checker", json());
+        if (remote.contains("signature")) signature = remote["signature"];
+        else if (builtin) signature = (*builtin)["signature"];
+        if (remote.contains("scaling")) scalingSpec = remote["scaling"];
+        else if (builtin) scalingSpec = builtin->value("scaling", json());
+    }
+    else if (builtin) {
+        signature = (*builtin)["signature"];
+        tests = (*builtin)["tests"];
+        scalingSpec = builtin->value("scaling", json());
+        profile = builtin->value("profile", "");
+        checkerSpec = builtin->value("checker", json());
+    }
+
+    if (signature.is_null()) {
+        err = "Problema desconocido o sin firma: " + id;
+        return nullptr;
+    }
+
+    std::shared_ptr<const ProblemDef> def;
+    try {
+        def = build_problem(id, signature, tests, scalingSpec, profile, checkerSpec);
+    }
+    catch (const std::exception& e) {
+        err = "Definición de problema inválida (" + id + "): " + e.what();
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lk(PROBLEMS_M);
+    PROBLEMS[id] = { def, now };
+    return def;
 }
 
-// =================== REVERSE STRING HARNESS ====================
-static std::string make_reverse_string_harness() {
-    return R"(#include <iostream>
-#include <vector>
-#include <string>
-#include <sstream>
-using namespace std;
+// ==================== PREPARACIÓN AL ARRANCAR ==================
+// Estado que se construye una vez en main() y luego solo se lee.
+struct CompileProfile {
+    std::string name;
+    std::vector<std::string> flags;
+    fs::path dir;                                  // PCH y objetos de los drivers de este perfil
+    std::vector<std::string> pchFlags;             // flags para usar el prelude/PCH
+    bool pch = false;                              // el PCH se pudo compilar
+};
 
-#include "user.cpp"
+struct Prebuilt {
+    std::string compiler;
+    std::string version;                           // primera línea de --version
+    fs::path dir;                                  // carpeta con prelude y perfiles
+    std::map<std::string, CompileProfile> profiles;
+    std::string defaultProfile = "fast";
+    int warmupMs = -1;                             // compilación de prueba al arrancar (-1 = falló)
+};
 
-void reverseString(vector<char>& s) {
-    Solution sol;
-    sol.reverseString(s);
+static Prebuilt PRE;
+static CompileCache CACHE;
+static WorkspacePool WORKSPACES;
+
+// Límites por ejecución (se ajustan con variables de entorno en main)
+static ProcLimits RUN_LIMITS;
+static ProcLimits COMPILE_LIMITS;
+
+// Contadores hardware por caso (perf_event_open); si no hay, solo rusage
+static bool PERF_COUNTERS = false;
+static std::string PERF_COUNTERS_NOTE;   // por qué no hay contadores
+
+#ifdef _WIN32
+static std::string native_path(const fs::path& p) { return short_path(p.string()); }
+#else
+static std::string native_path(const fs::path& p) { return p.string(); }
+#endif
+
+static bool is_clang(const std::string& compiler) {
+    return compiler.find("clang") != std::string::npos;
 }
 
-string to_str(const vector<char>& v) {
-    string s;
-    for(char c : v) s += c;
-    return s;
+// Ejecuta el compilador con los argumentos dados dentro de `cwd`.
+// La salida del compilador (stderr + stdout) queda en `log`. Si se pasa
+// `diagnostic`, indica si el fallo es un error real del código (el compilador
+// arrancó, terminó por sí solo y devolvió != 0) y no un plazo o un fallo al lanzarlo.
+static bool run_compiler(const fs::path& cwd, const std::vector<std::string>& args, std::string& log,
+    bool* diagnostic = nullptr) {
+    ProcSpec spec;
+    spec.argv.push_back(native_path(PRE.compiler));
+    spec.argv.insert(spec.argv.end(), args.begin(), args.end());
+    spec.cwd = native_path(cwd);
+    spec.limits = COMPILE_LIMITS;
+    ProcResult r = run_process(spec);
+    log = r.started ? r.err + r.out : r.error;
+    if (r.timedOut) log += "\n(compilación cancelada: tiempo límite excedido)";
+    if (diagnostic) {
+        *diagnostic = r.started && !r.timedOut && !r.outputExceeded && r.signal == 0 && r.exitCode != 0;
+    }
+    return r.ok();
 }
 
-int main() {
-    // Caso 1: "hello" -> "olleh"
-    vector<char> s1 = {'h','e','l','l','o'};
-    reverseString(s1);
-    cout << to_str(s1) << endl;
-    
-    // Caso 2: "Hannah" -> "hannaH"
-    vector<char> s2 = {'H','a','n','n','a','h'};
-    reverseString(s2);
-    cout << to_str(s2) << endl;
-    
-    return 0;
+static std::vector<std::string> flags_with(const CompileProfile& prof, std::initializer_list<std::string> extra) {
+    std::vector<std::string> v = prof.flags;
+    v.insert(v.end(), prof.pchFlags.begin(), prof.pchFlags.end());
+    v.insert(v.end(), extra.begin(), extra.end());
+    return v;
 }
-)";
+
+// Perfil con el que se compila un envío: "perf" si el problema lo pide o si
+// se va a medir la complejidad (medir tiempos sin optimizar no dice nada)
+static const CompileProfile& profile_for(const ProblemDef& p, bool measuring) {
+    std::string name = measuring ? "perf" : p.profile.empty() ? PRE.defaultProfile : p.profile;
+    auto it = PRE.profiles.find(name);
+    if (it == PRE.profiles.end()) it = PRE.profiles.find(PRE.defaultProfile);
+    return it->second;
 }
 
-// ==================== BINARY SEARCH HARNESS ====================
-static std::string make_binary_search_harness() {
-    return R"(#include <iostream>
-#include <vector>
-using namespace std;
+// Objeto del driver por perfil y firma: se compila la primera vez que se
+// necesita (o al arrancar, para los problemas conocidos) y luego se reutiliza.
+struct DriverObj {
+    std::once_flag once;
+    fs::path obj;   // vacío si no se pudo compilar
+};
 
-#include "user.cpp"
+static std::mutex DRIVERS_M;
+static std::unordered_map<std::string, std::shared_ptr<DriverObj>> DRIVERS;
 
-// Llama a Solution::search
-int search_wrapper(const vector<int>& nums, int target) {
-    Solution sol;
-    vector<int> copy = nums;
-    return sol.search(copy, target);
+static fs::path driver_object(const ProblemDef& p, const CompileProfile& prof) {
+    std::shared_ptr<DriverObj> d;
+    {
+        std::lock_guard<std::mutex> lk(DRIVERS_M);
+        auto& slot = DRIVERS[prof.name + '/' + p.sigKey];
+        if (!slot) slot = std::make_shared<DriverObj>();
+        d = slot;
+    }
+    std::call_once(d->once, [&]() {
+        std::string base = "driver_" + CompileCache::key({ p.sigKey, p.driver }).substr(0, 16);
+        write_file(prof.dir / (base + ".cpp"), p.driver);
+        std::string log;
+        if (run_compiler(prof.dir, flags_with(prof, { "-c", base + ".cpp", "-o", base + ".o" }), log)) {
+            d->obj = prof.dir / (base + ".o");
+        }
+        else {
+            std::printf("[EV] Aviso: no se pudo precompilar el driver de '%s' (%s)\n",
+                p.id.c_str(), prof.name.c_str());
+        }
+        });
+    return d->obj;
 }
 
-int main() {
-    {
-        vector<int> nums = {-1,0,3,5,9,12};
-        int target = 9;
-        int res = search_wrapper(nums, target);
-        cout << res << "\n";   // Esperado: 4
+// PCH del prelude con los flags del perfil. Si falla se usa el prelude sin precompilar.
+static void prepare_pch(CompileProfile& prof) {
+    std::error_code ec;
+    fs::create_directories(prof.dir, ec);
+    std::string prelude = native_path(PRE.dir / "prelude.hpp");
+    std::string pchOut = is_clang(PRE.compiler) ? "prelude.hpp.pch" : "prelude.hpp.gch";
+    std::vector<std::string> pch = prof.flags;
+    pch.insert(pch.end(), { "-x", "c++-header", prelude, "-o", pchOut });
+
+    std::string log;
+    prof.pch = run_compiler(prof.dir, pch, log);
+    if (!prof.pch) {
+        std::printf("[EV] Aviso: no se pudo precompilar el prelude (%s), se usará sin PCH\n", prof.name.c_str());
+        prof.pchFlags = { "-include", prelude };
     }
-    {
-        vector<int> nums = {-1,0,3,5,9,12};
-        int target = 2;
-        int res = search_wrapper(nums, target);
-        cout << res << "\n";   // Esperado: -1
+    else if (is_clang(PRE.compiler)) {
+        prof.pchFlags = { "-include-pch", native_path(prof.dir / pchOut), "-include", prelude };
     }
-    {
-        vector<int> nums = {1};
-        int target = 1;
-        int res = search_wrapper(nums, target);
-        cout << res << "\n";   // Esperado: 0
+    else {
+        // GCC busca <dir>/prelude.hpp.gch al ver -include <dir>/prelude.hpp:
+        // cada perfil tiene su copia del prelude junto a su .gch
+        write_file(prof.dir / "prelude.hpp", PRELUDE);
+        prof.pchFlags = { "-include", native_path(prof.dir / "prelude.hpp") };
     }
-    {
-        vector<int> nums = {1};
-        int target = 2;
-        int res = search_wrapper(nums, target);
-        cout << res << "\n";   // Esperado: -1
+}
+
+// Descubre el compilador, compila el prelude como PCH y el driver de cada
+// problema conocido a objeto en cada perfil, y hace una compilación completa
+// de prueba para dejar el compilador y las cabeceras en la caché del sistema.
+// Si algo falla se cae de forma silenciosa al camino lento (compilar todo).
+static void prepare_harnesses() {
+    PRE.compiler = find_compiler(PRE.version);
+    if (PRE.compiler.empty()) return;
+    std::printf("[EV] Compilador: %s (%s)\n", PRE.compiler.c_str(), PRE.version.c_str());
+
+    PRE.dir = fs::temp_directory_path() / "cc_eval_prebuilt";
+    std::error_code ec;
+    fs::create_directories(PRE.dir, ec);
+    write_file(PRE.dir / "prelude.hpp", PRELUDE);
+
+    // pchFlags y pch los rellena prepare_pch()
+    auto add_profile = [](const std::string& name, const char* env, const char* def) {
+        const char* flags = std::getenv(env);
+        CompileProfile p;
+        p.name = name;
+        p.flags = split_flags(flags && *flags ? flags : def);
+        p.dir = PRE.dir / name;
+        PRE.profiles[name] = std::move(p);
+    };
+    add_profile("fast", "CC_EVAL_FAST_FLAGS", FAST_FLAGS);
+    add_profile("perf", "CC_EVAL_PERF_FLAGS", PERF_FLAGS);
+    if (const char* d = std::getenv("CC_EVAL_PROFILE"); d && PRE.profiles.count(d)) PRE.defaultProfile = d;
+
+    for (auto& [name, prof] : PRE.profiles) {
+        prepare_pch(prof);
+        size_t ready = 0;
+        for (const auto& b : builtin_problems()) {
+            try {
+                auto def = build_problem(b["id"], b["signature"], b["tests"]);
+                if (!driver_object(*def, prof).empty()) ++ready;
+            }
+            catch (const std::exception& e) {
+                std::printf("[EV] Aviso: problema interno inválido: %s\n", e.what());
+            }
+        }
+        std::printf("[EV] Drivers precompilados (%s): %zu/%zu\n", name.c_str(), ready, builtin_problems().size());
     }
-    return 0;
+
+    // Compilación de prueba (compilar y enlazar) con el perfil por defecto
+    const CompileProfile& prof = PRE.profiles[PRE.defaultProfile];
+    fs::path dir = PRE.dir / "warmup";
+    fs::create_directories(dir, ec);
+    write_file(dir / "warmup.cpp", "int main() { vector<int> v{ 1 }; cout << v.size() << endl; }\n");
+    std::string log;
+    auto t0 = std::chrono::steady_clock::now();
+    if (run_compiler(dir, flags_with(prof, { "-o", "warmup", "warmup.cpp" }), log)) {
+        PRE.warmupMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+    }
+    fs::remove_all(dir, ec);
+    std::printf("[EV] Perfil por defecto: %s, compilación de prueba: %d ms\n",
+        PRE.defaultProfile.c_str(), PRE.warmupMs);
 }
-)";
+
+// ========================== VEREDICTOS =========================
+// Veredicto de una ejecución según cómo terminó el proceso ("OK" si terminó bien)
+static std::string run_verdict(const ProcResult& r, const ProcLimits& lim) {
+    if (!r.started) return "RE";
+    if (r.outputExceeded || r.quotaExceeded) return "OLE";
+    if (r.timedOut) return "TLE";
+    bool failed = r.signal != 0 || r.exitCode != 0;
+    if (!failed) return "OK";
+    // Con RLIMIT_AS la reserva falla mucho antes de que el RSS se acerque al
+    // límite: manda lo que dejó en stderr. El driver marca toda reserva
+    // fallida (harness_gen::alloc_failed), así un bad_alloc capturado que
+    // acaba en SIGSEGV/SIGABRT también es MLE; fuera del driver queda el
+    // texto de bad_alloc o de ENOMEM, y el RSS cerca del límite como último recurso.
+    bool oom = harness_gen::alloc_failed(r.err)
+        || r.err.find("bad_alloc") != std::string::npos
+        || r.err.find("Cannot allocate memory") != std::string::npos
+        || (lim.memoryKB > 0 && r.maxRssKB * 10 >= lim.memoryKB * 9);
+    return oom ? "MLE" : "RE";
 }
 
-// ================== COUNT NEGATIVES HARNESS ====================
-static std::string make_count_negatives_harness() {
-    return R"(#include <iostream>
-#include <vector>
-using namespace std;
+static std::string verdict_note(const std::string& verdict, const ProcResult& r) {
+    if (verdict == "TLE") return "Tiempo límite excedido";
+    if (verdict == "MLE") return "Memoria límite excedida";
+    if (verdict == "OLE") return "Salida límite excedida";
+    if (!r.started) return "No se pudo ejecutar el programa: " + r.error;
+    if (r.signal != 0) return "El programa terminó por la señal " + std::to_string(r.signal);
+    return "El programa terminó con código " + std::to_string(r.exitCode);
+}
+
+// ========================= EJECUCIÓN POR CASO ==================
+struct CaseOutcome {
+    bool ran = false;
+    std::string verdict;      // AC, WA, RE, TLE, MLE, OLE
+    std::string stdoutLine;   // línea de resultado impresa por el driver
+    harness_gen::HeapStats heap;   // reservas de la llamada a la solución
+    ProcResult proc;
+};
 
-#include "user.cpp"
+// Casos que se ejecutan en paralelo dentro de un mismo envío
+static size_t CASE_PARALLEL = 1;
 
-// Se asume que Solution tiene:
-// int solve(vector<int>& nums);
-int solve_wrapper(vector<int> nums) {
-    Solution sol;
-    return sol.solve(nums);
+// La última línea no vacía es el resultado; lo anterior suelen ser trazas del estudiante
+static std::string result_line(std::string out) {
+    out.erase(std::remove(out.begin(), out.end(), '\r'), out.end());
+    size_t end = out.find_last_not_of('\n');
+    if (end == std::string::npos) return "";
+    size_t start = out.rfind('\n', end);
+    start = (start == std::string::npos) ? 0 : start + 1;
+    return out.substr(start, end - start + 1);
 }
 
-int main() {
-    {
-        vector<int> nums = {-1, 2, -5, 7};
-        int res = solve_wrapper(nums);
-        cout << res << "\n";   // Esperado: 2
-    }
-    {
-        vector<int> nums = {-1, -2, -3};
-        int res = solve_wrapper(nums);
-        cout << res << "\n";   // Esperado: 3
-    }
-    {
-        vector<int> nums = {3, 4, 1};
-        int res = solve_wrapper(nums);
-        cout << res << "\n";   // Esperado: 0
-    }
-    return 0;
+// Contadores de un caso (o sumados) para la respuesta; omite los no disponibles
+static json counters_json(const perf_counters::Counters& c) {
+    json out = { {"instructions", c.instructions}, {"cycles", c.cycles} };
+    if (c.cycles > 0) out["ipc"] = (double)c.instructions / (double)c.cycles;
+    if (c.cacheMisses >= 0) out["cacheMisses"] = c.cacheMisses;
+    if (c.branchMisses >= 0) out["branchMisses"] = c.branchMisses;
+    if (c.scaled) out["scaled"] = true;
+    return out;
 }
-)";
+
+// La salida se compara mientras el programa corre: a la primera diferencia
+// se le mata y el caso es WA sin esperar a que termine ni guardar su salida.
+// `withinQuota` vigila el disco del workspace mientras corre (ver run_process)
+static CaseOutcome run_case(const fs::path& dir, const std::string& exe, const TestCase& tc,
+    const OutputChecker::Spec& check, const std::function<bool()>& withinQuota,
+    const trace::Context& parent) {
+    trace::Span span("case", parent);
+    OutputChecker checker(tc.expectedText, check);
+    ProcSpec spec;
+    spec.argv = { exe };
+    spec.cwd = native_path(dir);
+    spec.limits = RUN_LIMITS;
+    spec.stdinData = "1\n" + tc.input;
+    spec.onStdout = [&checker](const char* p, size_t n) { return checker.feed(p, n); };
+    spec.withinQuota = withinQuota;
+    spec.counters = PERF_COUNTERS;
+
+    CaseOutcome c;
+    c.ran = true;
+    c.proc = run_process(spec);
+    c.stdoutLine = checker.shown();
+    c.heap = harness_gen::take_heap_stats(c.proc.err);
+
+    std::string rv = run_verdict(c.proc, RUN_LIMITS);
+    if (c.proc.stopped) c.verdict = "WA";
+    else if (rv != "OK") c.verdict = rv;
+    else c.verdict = checker.matched() ? "AC" : "WA";
+    span.attr("verdict", c.verdict).attr("cpuMs", (int)c.proc.cpuMs())
+        .attr("earlyAbort", c.proc.stopped).attr("traceBytes", checker.trace_bytes());
+    if (c.proc.counters.valid) span.attr("instructions", c.proc.counters.instructions);
+    if (c.heap.valid) span.attr("allocs", c.heap.allocs);
+    return c;
 }
 
+// ========================== MÉTRICAS ===========================
+// Las fases del pipeline se miden aquí; GET /metrics las publica junto con
+// las de HTTP y las que se leen del pool y la caché al vuelo (ver main)
+static metrics::Histogram& M_QUEUE_WAIT = metrics::registry().histogram(
+    "cc_eval_queue_wait_seconds", "Espera en la cola del pool");
+static metrics::Histogram& M_COMPILE = metrics::registry().histogram(
+    "cc_eval_compile_seconds", "Compilación (o consulta a la caché) de un envío");
+static metrics::Histogram& M_RUN = metrics::registry().histogram(
+    "cc_eval_run_seconds", "Ejecución de todos los casos de un envío");
+static metrics::Family<metrics::Counter>& M_VERDICTS = metrics::registry().counter_family(
+    "cc_eval_submissions_total", "Envíos terminados por veredicto", { "verdict" });
+
 // ======================= PIPELINE GENÉRICO =====================
-static void run_pipeline(const std::string& id,
-    const std::string& userSource,
-    const std::string& problemType) {
+// Opciones por envío
+struct RunOptions {
+    bool stopOnFirstFailure = false;   // no lanzar más casos tras el primer fallo
+    bool measureComplexity = false;    // tras un AC, medir cómo crece el tiempo con n
+    trace::Context trace;              // span de la petición que creó el envío
+};
 
-    auto tStart = std::chrono::steady_clock::now();
-    std::string compiler = find_compiler();
+// ===================== COMPLEJIDAD EMPÍRICA ====================
+// Tiempo total (pared) que puede gastar la medición de un envío
+static int64_t SCALING_BUDGET_MS = 10000;
+
+// Ejecuta el binario ya aceptado en modo medición con entradas de tamaño
+// creciente (ver scaling.hpp) y devuelve la clase ajustada con los puntos.
+// Se detiene al primer fallo, cuando el siguiente tamaño no cabría en el
+// límite de CPU o al agotar el presupuesto.
+static json measure_complexity(const std::string& id, const fs::path& dir,
+    const std::string& exe, const ProblemDef& problem, const std::function<bool()>& withinQuota,
+    const trace::Context& parent) {
+    trace::Span span("measure_complexity", parent);
+    const scaling::Spec spec = problem.scaling.value_or(scaling::Spec{});
+    STORE.update(id, [&](Submission& s) { s.casesTotal += (int)spec.sizes.size(); }, false);
+
+    json out = json::object();
+    std::vector<scaling::Point> pts;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < spec.sizes.size(); ++i) {
+        const int n = spec.sizes[i];
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (elapsed >= SCALING_BUDGET_MS) {
+            out["stoppedAt"] = { {"n", n}, {"reason", "budget"} };
+            break;
+        }
 
-    if (compiler.empty()) {
-        std::lock_guard<std::mutex> lk(DBM);
-        DB[id].status = "done";
-        DB[id].errorMsg = "No se encontró compilador C++";
-        DB[id].results = json::array();
-        return;
+        std::mt19937 rng((uint32_t)n);
+        ProcSpec ps;
+        ps.argv = { exe };
+        ps.cwd = native_path(dir);
+        ps.limits = RUN_LIMITS;
+        ps.withinQuota = withinQuota;
+        try {
+            ps.stdinData = "-" + std::to_string(spec.budgetMs) + "\n"
+                + scaling::generate_case(problem.sig, spec, n, rng);
+        }
+        catch (const std::exception& e) {
+            out["error"] = std::string("No se pudo generar la entrada: ") + e.what();
+            break;
+        }
+        ProcResult r = run_process(ps);
+        STORE.update(id, [](Submission& s) { ++s.casesDone; }, false);
+
+        std::string rv = run_verdict(r, RUN_LIMITS);
+        long long ns = -1, reps = 0;
+        if (rv == "OK") {
+            std::istringstream line(result_line(std::move(r.out)));
+            if (!(line >> ns >> reps) || ns < 0) rv = "RE";
+        }
+        if (rv != "OK") {
+            out["stoppedAt"] = { {"n", n}, {"reason", rv} };
+            break;
+        }
+        pts.push_back(scaling::Point{ n, ns, (int)reps });
+
+        // Extrapolar con la pendiente log-log de los dos últimos puntos: si el
+        // siguiente tamaño no cabe en la mitad del límite, no se lanza
+        size_t k = pts.size();
+        if (RUN_LIMITS.cpuMs > 0 && k >= 2 && i + 1 < spec.sizes.size()) {
+            const auto& a = pts[k - 2];
+            const auto& b = pts[k - 1];
+            double slope = std::log((double)std::max<int64_t>(1, b.ns) / (double)std::max<int64_t>(1, a.ns))
+                / std::log((double)b.n / (double)a.n);
+            double next = (double)b.ns * std::pow((double)spec.sizes[i + 1] / (double)b.n, std::max(0.0, slope));
+            if (next > (double)RUN_LIMITS.cpuMs * 1e6 / 2) {
+                out["stoppedAt"] = { {"n", spec.sizes[i + 1]}, {"reason", "slow"} };
+                break;
+            }
+        }
     }
 
-    fs::path tmp = fs::temp_directory_path() / rand_id("cc_eval_");
-    fs::create_directories(tmp);
+    json points = json::array();
+    for (const auto& p : pts) points.push_back({ {"n", p.n}, {"ns", p.ns}, {"reps", p.reps} });
+    out["points"] = std::move(points);
 
-    fs::path userp = tmp / "user.cpp";
-    fs::path mainp = tmp / "main.cpp";
+    auto f = scaling::fit(pts);
+    if (!f.best.empty()) {
+        out["class"] = f.best;
+        out["fit"] = std::move(f.errors);
+    }
+    span.attr("points", (int)pts.size()).attr("class", f.best);
+    if (!spec.expected.empty()) {
+        out["expected"] = spec.expected;
+        int got = scaling::model_rank(f.best), want = scaling::model_rank(spec.expected);
+        if (got >= 0 && want >= 0) out["meetsExpected"] = got <= want;
+    }
+    return out;
+}
 
-    write_file(userp, userSource);
+static void run_pipeline(const std::string& id,
+    const std::string& userSource,
+    const std::string& problemId,
+    const RunOptions& opts) {
 
-    // Elegir harness según el tipo de problema
-    std::string harness;
-    std::vector<std::string> expected_outputs;
+    trace::Span root("pipeline", opts.trace);
+    root.attr("submissionId", id).attr("problemId", problemId);
 
-    if (problemType == "two-sum") {
-        harness = make_two_sum_harness();
-        expected_outputs = { "[0,1]", "[1,2]" };
-    }
-    else if (problemType == "reverse-string") {
-        harness = make_reverse_string_harness();
-        expected_outputs = { "olleh", "hannaH" };
-    }
-    else if (problemType == "binary-search") {
-        harness = make_binary_search_harness();
-        expected_outputs = { "4", "-1", "0", "-1" };
-    }
-    else if (problemType == "count-negatives") {
-        harness = make_count_negatives_harness();
-        expected_outputs = { "2", "3", "0" };
-    }
-    else {
-        // Fallback: usa two-sum si llega algo inesperado
-        harness = make_two_sum_harness();
-        expected_outputs = { "[0,1]", "[1,2]" };
+    if (PRE.compiler.empty()) {
+        STORE.update(id, [](Submission& s) {
+            s.status = "done";
+            s.errorMsg = "No se encontró compilador C++";
+            s.results = json::array();
+            });
+        M_VERDICTS.with({ "error" }).inc();
+        return;
     }
 
-    write_file(mainp, harness);
+    std::string perr;
+    auto problem = load_problem(problemId, perr, root.context());
+    if (!problem) {
+        STORE.update(id, [&](Submission& s) {
+            s.status = "done";
+            s.errorMsg = perr;
+            s.results = json::array();
+            });
+        M_VERDICTS.with({ "error" }).inc();
+        return;
+    }
 
-#ifdef _WIN32
-    std::string compS = short_path(compiler);
-    std::string tmpS = short_path(tmp.string());
-#else
-    std::string compS = compiler;
-    std::string tmpS = tmp.string();
-#endif
+    // Workspace reciclado del pool: se vacía y vuelve al pool al salir de aquí
+    trace::Span setup("setup_workspace", root.context());
+    WorkspacePool::Lease ws = WORKSPACES.lease();
+    const fs::path tmp = ws.path();
 
-    // Compilar
-    std::ostringstream ccmd;
-#ifdef _WIN32
-    ccmd << "cmd /S /C \"cd /d \"" << tmpS
-        << "\" && \"" << compS
-        << "\" -std=c++17 -O2 -o a.exe main.cpp > compile.err 2>&1\"";
-#else
-    ccmd << "cd \"" << tmpS << "\" && \"" << compS
-        << "\" -std=c++17 -O2 -o a.out main.cpp > compile.err 2>&1";
-#endif
-
-    int cexit = std::system(ccmd.str().c_str());
-    std::string cerrtxt = read_file(tmp / "compile.err");
+    {
+        trace::Span w("write_file", setup.context());
+        write_file(tmp / "user.cpp", userSource);
+        write_file(tmp / "entry.cpp", "#include \"user.cpp\"\n" + problem->adapter);
+        w.attr("bytes", (int64_t)(userSource.size() + problem->adapter.size()));
+    }
+    setup.end();
 
 #ifdef _WIN32
     std::string exeName = "a.exe";
@@ -330,78 +784,494 @@ static void run_pipeline(const std::string& id,
     std::string exeName = "a.out";
 #endif
 
-    if (cexit != 0) {
-        std::lock_guard<std::mutex> lk(DBM);
-        DB[id].status = "done";
-        DB[id].errorMsg = "Error de compilación:\n" + cerrtxt;
+    // Solo se compila la unidad del estudiante; el driver ya está en objeto
+    const CompileProfile& prof = profile_for(*problem, opts.measureComplexity);
+    std::vector<std::string> cargs = flags_with(prof, { "-o", exeName, "entry.cpp" });
+    fs::path obj = driver_object(*problem, prof);
+    if (!obj.empty()) {
+        cargs.push_back(native_path(obj));
+    }
+    else {
+        write_file(tmp / "driver.cpp", problem->driver);
+        cargs.push_back("driver.cpp");
+    }
+
+    // Caché de compilación: mismo código + harness + compilador (y versión) + flags => mismo binario
+    std::string flagKey;
+    for (const auto& f : prof.flags) flagKey += f + ' ';
+    std::string ckey = CompileCache::key({ userSource, problem->adapter, problem->driver,
+        PRELUDE, PRE.compiler, PRE.version, flagKey });
+    trace::Span compile("compile", root.context());
+    compile.attr("profile", prof.name);
+    auto tCompile0 = std::chrono::steady_clock::now();
+    auto cached = CACHE.lookup(ckey, tmp / exeName);
+    compile.attr("cached", cached.has_value());
+    auto compile_ms = [&]() {
+        return (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - tCompile0).count();
+    };
+    auto compile_failed = [&]() {
+        M_COMPILE.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - tCompile0).count());
+        M_VERDICTS.with({ "CE" }).inc();
+        compile.attr("verdict", "CE");
+    };
+
+    if (cached && !cached->ok) {
+        STORE.update(id, [&](Submission& s) {
+            s.status = "done";
+            s.compileMs = compile_ms();
+            s.profile = prof.name;
+            s.cached = true;
+            s.verdict = "CE";
+            s.errorMsg = "Error de compilación:\n" + cached->errors;
+            });
+        compile_failed();
         return;
     }
 
-    // Ejecutar
-    std::ostringstream rcmd;
+    if (!cached) {
+        std::string cerrtxt;
+        bool diagnostic = false;
+        if (!run_compiler(tmp, cargs, cerrtxt, &diagnostic)) {
+            // Plazos y fallos al lanzar el compilador son pasajeros: no se cachean
+            if (diagnostic) CACHE.store_error(ckey, cerrtxt);
+            STORE.update(id, [&](Submission& s) {
+                s.status = "done";
+                s.compileMs = compile_ms();
+                s.profile = prof.name;
+                s.verdict = "CE";
+                s.errorMsg = "Error de compilación:\n" + cerrtxt;
+                });
+            compile_failed();
+            return;
+        }
+        CACHE.store_binary(ckey, tmp / exeName);
+    }
+
+    const size_t ncases = problem->tests.size();
+    const int compileMs = compile_ms();
+    const bool fromCache = cached.has_value();
+    M_COMPILE.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - tCompile0).count());
+    compile.end();
+    STORE.update(id, [&](Submission& s) {
+        s.status = "running";
+        s.compileMs = compileMs;
+        s.profile = prof.name;
+        s.cached = fromCache;
+        s.casesDone = 0;
+        s.casesTotal = (int)ncases;
+        });
+
+    // Un proceso por caso: cada uno con sus propios límites, tiempo y memoria,
+    // de modo que un caso lento o que se cae no contamina a los demás.
 #ifdef _WIN32
-    rcmd << "cmd /S /C \"cd /d \"" << tmpS << "\" && \"" << exeName
-        << "\" > run.out 2>&1\"";
+    const std::string exePath = exeName;
 #else
-    rcmd << "cd \"" << tmpS << "\" && \"" << exeName
-        << "\" > run.out 2>&1";
+    const std::string exePath = "./" + exeName;
 #endif
+    std::vector<CaseOutcome> outcomes(ncases);
+    std::atomic<size_t> next{ 0 };
+    std::atomic<bool> stop{ false };
+    // Ficheros escritos por el programa: cada uno tiene RLIMIT_FSIZE y el total
+    // del workspace se vigila durante cada ejecución; pasarse de la cuota es OLE
+    const std::function<bool()> withinQuota = [&ws] { return !ws.over_quota(); };
+    trace::Span run("run", root.context());
+    run.attr("cases", (int)ncases);
+
+    auto worker = [&]() {
+        for (;;) {
+            if (stop.load()) return;
+            size_t i = next.fetch_add(1);
+            if (i >= ncases) return;
+            outcomes[i] = run_case(tmp, exePath, problem->tests[i], problem->check, withinQuota, run.context());
+            // Lo que quede por encima de la cuota al acabar el caso (escrito entre dos consultas)
+            if (outcomes[i].proc.quotaExceeded || ws.over_quota()) {
+                outcomes[i].verdict = "OLE";
+                stop.store(true);
+            }
+            if (outcomes[i].verdict != "AC" && opts.stopOnFirstFailure) stop.store(true);
+            STORE.update(id, [](Submission& s) { ++s.casesDone; }, false);
+        }
+    };
 
-    auto t0 = std::chrono::steady_clock::now();
-    int rexit = std::system(rcmd.str().c_str());
-    auto t1 = std::chrono::steady_clock::now();
-    (void)rexit;
+    auto tRun0 = std::chrono::steady_clock::now();
+    size_t par = std::min(CASE_PARALLEL, ncases);
+    std::vector<std::thread> extra;
+    for (size_t k = 1; k < par; ++k) extra.emplace_back(worker);
+    worker();
+    for (auto& t : extra) t.join();
+    auto tRun1 = std::chrono::steady_clock::now();
+    run.end();
 
-    int totalMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-    std::string out = read_file(tmp / "run.out");
+    // Agregar: el veredicto global es el del primer caso (en orden) que falla
+    json results = json::array();
+    std::string verdict = "AC";
+    std::string note;
+    int cpuMs = 0, userMs = 0, sysMs = 0, peakKB = 0;
+    perf_counters::Counters total;
+    harness_gen::HeapStats heap;
+    total.valid = PERF_COUNTERS;
+    total.instructions = total.cycles = total.cacheMisses = total.branchMisses = 0;
+    for (size_t i = 0; i < ncases; ++i) {
+        const CaseOutcome& c = outcomes[i];
+        const TestCase& tc = problem->tests[i];
+        if (!c.ran) {
+            results.push_back(json{
+                {"case", (int)i + 1},
+                {"pass", false},
+                {"skipped", true},
+                {"expected", tc.expectedText}
+                });
+            continue;
+        }
 
-    // Limpiar \r de Windows
-    out.erase(std::remove(out.begin(), out.end(), '\r'), out.end());
+        cpuMs += (int)c.proc.cpuMs();
+        userMs += (int)c.proc.userMs;
+        sysMs += (int)c.proc.sysMs;
+        peakKB = std::max(peakKB, (int)c.proc.maxRssKB);
+        const perf_counters::Counters& pc = c.proc.counters;
+        total.valid = total.valid && pc.valid;
+        total.scaled = total.scaled || pc.scaled;
+        total.instructions += std::max<int64_t>(pc.instructions, 0);
+        total.cycles += std::max<int64_t>(pc.cycles, 0);
+        total.cacheMisses = pc.cacheMisses < 0 || total.cacheMisses < 0 ? -1 : total.cacheMisses + pc.cacheMisses;
+        total.branchMisses = pc.branchMisses < 0 || total.branchMisses < 0 ? -1 : total.branchMisses + pc.branchMisses;
+        if (c.verdict != "AC" && verdict == "AC") {
+            verdict = c.verdict;
+            if (c.verdict != "WA") {
+                note = "Caso " + std::to_string(i + 1) + ": " + verdict_note(c.verdict, c.proc);
+            }
+        }
 
-    std::vector<std::string> lines;
-    std::istringstream ss(out);
-    std::string line;
-    while (std::getline(ss, line)) {
-        if (!line.empty()) {
-            lines.push_back(line);
+        json r = {
+            {"case",  (int)i + 1},
+            {"pass",  c.verdict == "AC"},
+            {"verdict", c.verdict},
+            {"stdout", c.stdoutLine},
+            {"expected", tc.expectedText},
+            {"timeMs", (int)c.proc.cpuMs()},
+            {"wallMs", (int)c.proc.wallMs},
+            {"memoryKB", (int)c.proc.maxRssKB}
+        };
+        if (pc.valid) r["counters"] = counters_json(pc);
+        if (c.heap.valid) {
+            r["heap"] = { {"allocs", c.heap.allocs}, {"bytes", c.heap.bytes}, {"peakBytes", c.heap.peakBytes} };
+            heap.valid = true;
+            heap.allocs += c.heap.allocs;
+            heap.bytes += c.heap.bytes;
+            heap.peakBytes = std::max(heap.peakBytes, c.heap.peakBytes);
         }
+        results.push_back(std::move(r));
     }
 
-    json results = json::array();
-    int ncases = (int)expected_outputs.size();
-    int perCaseMs = (ncases > 0) ? totalMs / ncases : totalMs;
+    // Puntuación de eficiencia estable: instrucciones de todos los casos si
+    // todos las tienen; si no, el tiempo de CPU
+    json efficiency;
+    if (total.valid) {
+        efficiency = counters_json(total);
+        efficiency["source"] = "perf";
+    }
+    else {
+        efficiency = { {"source", "rusage"}, {"cpuMs", cpuMs} };
+        if (!PERF_COUNTERS_NOTE.empty()) efficiency["note"] = PERF_COUNTERS_NOTE;
+    }
 
-    for (size_t i = 0; i < expected_outputs.size(); ++i) {
-        std::string expected = expected_outputs[i];
-        std::string obtained = (i < lines.size()) ? lines[i] : "";
+    const int runWallMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(tRun1 - tRun0).count();
+    M_RUN.observe(std::chrono::duration<double>(tRun1 - tRun0).count());
+    M_VERDICTS.with({ verdict }).inc();
+    const bool measure = opts.measureComplexity && verdict == "AC";
+    STORE.update(id, [&](Submission& sub) {
+        sub.errorMsg = note;
+        sub.verdict = verdict;
+        sub.status = measure ? "running" : "done";
+        sub.results = std::move(results);
+        sub.timeMs = cpuMs;
+        sub.wallMs = runWallMs;
+        sub.userMs = userMs;
+        sub.sysMs = sysMs;
+        sub.memoryKB = peakKB;
+        sub.efficiency = std::move(efficiency);
+        if (heap.valid) sub.heap = { {"allocs", heap.allocs}, {"bytes", heap.bytes}, {"peakBytes", heap.peakBytes} };
+        });
+    if (!measure) return;
 
-        bool pass = (expected == obtained);
+    // Los resultados ya están publicados; la medición solo añade "complexity"
+    json complexity = measure_complexity(id, tmp, exePath, *problem, withinQuota, root.context());
+    STORE.update(id, [&](Submission& sub) {
+        sub.complexity = std::move(complexity);
+        sub.status = "done";
+        });
+}
 
-        results.push_back(json{
-            {"case",  (int)i + 1},
-            {"pass",  pass},
-            {"stdout", obtained},
-            {"timeMs", perCaseMs}
+// Encola la submission `id` (ya guardada en STORE). Devuelve el ticket o NO_TICKET si la cola está llena.
+// `parent` es el span de la petición HTTP que la creó (vacío al reanudar tras un reinicio).
+static uint64_t enqueue(WorkerPool& pool, const Submission& sub, const trace::Context& parent = {}) {
+    RunOptions opts;
+    opts.trace = parent;
+    opts.stopOnFirstFailure = sub.stopOnFirstFailure;
+    opts.measureComplexity = sub.measureComplexity;
+    const std::string id = sub.id, pid = sub.problemId, src = sub.source;
+
+    const auto queuedAt = std::chrono::steady_clock::now();
+    uint64_t ticket = pool.submit([id, pid, src, opts, queuedAt]() {
+        const auto waited = std::chrono::steady_clock::now() - queuedAt;
+        const int queueMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(waited).count();
+        M_QUEUE_WAIT.observe(std::chrono::duration<double>(waited).count());
+        trace::Span("queue_wait", opts.trace, queuedAt).attr("queueMs", queueMs);
+        STORE.update(id, [queueMs](Submission& s) {
+            s.status = "compiling";
+            s.queueMs = queueMs;
             });
+        run_pipeline(id, src, pid, opts);
+        });
+    if (ticket != WorkerPool::NO_TICKET) {
+        STORE.update(id, [ticket](Submission& s) { s.ticket = ticket; });
     }
+    return ticket;
+}
 
-    std::lock_guard<std::mutex> lk(DBM);
-    DB[id].status = "done";
-    DB[id].results = results;
-    DB[id].timeMs = totalMs;
+// Respuesta de GET /submissions/{id} (y de cada evento del stream)
+static json status_json(const Submission& s, const WorkerPool& pool) {
+    json out = {
+        {"status", s.status},
+        {"version", s.version},
+        {"results", s.results},
+        {"timeMs", s.timeMs},
+        {"memoryKB", s.memoryKB},
+        {"wallMs", s.wallMs},
+        {"userMs", s.userMs},
+        {"sysMs", s.sysMs},
+        {"queueMs", s.queueMs},
+        {"compileMs", s.compileMs},
+        {"profile", s.profile},
+        {"cached", s.cached}
+    };
+    if (!s.verdict.empty()) out["verdict"] = s.verdict;
+    if (s.status == "queued") out["queuePosition"] = pool.position(s.ticket);
+    if (s.status == "running") out["progress"] = { {"done", s.casesDone}, {"total", s.casesTotal} };
+    if (!s.errorMsg.empty()) out["note"] = s.errorMsg;
+    if (!s.complexity.is_null()) out["complexity"] = s.complexity;
+    if (!s.efficiency.is_null()) out["efficiency"] = s.efficiency;
+    if (!s.heap.is_null()) out["heap"] = s.heap;
+    return out;
 }
 
 // =========================== SERVER ============================
+// Peticiones que retienen un hilo HTTP mientras esperan (streams SSE y
+// long-polls). Se acotan para que siempre queden hilos libres para POST,
+// /health y /metrics: por encima del tope, un stream recibe 503 (la UI pasa
+// a consultar periódicamente) y un long-poll responde sin esperar.
+static std::atomic<size_t> WAITERS{ 0 };
+static size_t MAX_WAITERS = 0;
+
+static bool acquire_waiter() {
+    size_t n = WAITERS.load();
+    while (n < MAX_WAITERS) {
+        if (WAITERS.compare_exchange_weak(n, n + 1)) return true;
+    }
+    return false;
+}
+
+static void release_waiter() { WAITERS.fetch_sub(1); }
+
 int main() {
+#ifndef _WIN32
+    // Escribir en el stdin de un hijo que ya terminó no debe tumbar el servidor
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
     httplib::Server svr;
 
+    // Límites de recursos por ejecución y por compilación
+    RUN_LIMITS.cpuMs = (int64_t)env_size("CC_EVAL_TIME_MS", 2000);
+    RUN_LIMITS.wallMs = (int64_t)env_size("CC_EVAL_WALL_MS", 3 * (size_t)RUN_LIMITS.cpuMs);
+    RUN_LIMITS.memoryKB = (int64_t)env_size("CC_EVAL_MEMORY_MB", 256) * 1024;
+    RUN_LIMITS.outputBytes = (int64_t)env_size("CC_EVAL_OUTPUT_KB", 1024) * 1024;
+    RUN_LIMITS.fileBytes = RUN_LIMITS.outputBytes;
+    RUN_LIMITS.openFiles = (int64_t)env_size("CC_EVAL_OPEN_FILES", 64);
+    COMPILE_LIMITS.wallMs = (int64_t)env_size("CC_EVAL_COMPILE_MS", 30000);
+    COMPILE_LIMITS.outputBytes = 1024 * 1024;
+
+    // Contadores hardware: se intentan salvo CC_EVAL_PERF_COUNTERS=0
+    const char* pcEnv = std::getenv("CC_EVAL_PERF_COUNTERS");
+    if (pcEnv && std::string(pcEnv) == "0") PERF_COUNTERS_NOTE = "desactivados (CC_EVAL_PERF_COUNTERS=0)";
+    else PERF_COUNTERS = perf_counters::probe(PERF_COUNTERS_NOTE);
+    std::printf("[EV] Contadores hardware: %s\n", PERF_COUNTERS ? "perf_event_open" : ("rusage, " + PERF_COUNTERS_NOTE).c_str());
+
+    // Problem Manager del que se leen firmas y tests
+    if (const char* h = std::getenv("CC_EVAL_PM_HOST")) PM_HOST = h;
+    PM_PORT = (int)env_size("CC_EVAL_PM_PORT", 8084);
+    PROBLEM_TTL = std::chrono::seconds(env_size("CC_EVAL_PROBLEM_TTL_S", 60));
+
+    // Descubrir compilador y precompilar prelude + drivers una sola vez
+    prepare_harnesses();
+
+    const fs::path cacheDir = std::getenv("CC_EVAL_CACHE_DIR")
+        ? fs::path(std::getenv("CC_EVAL_CACHE_DIR"))
+        : fs::temp_directory_path() / "cc_eval_cache";
+    CACHE.init(cacheDir, (uint64_t)env_size("CC_EVAL_CACHE_MB", 256) * 1024 * 1024);
+
+    // Trazas: ring buffer en memoria (GET /traces) y, opcionalmente, fichero JSONL
+    trace::Tracer::Config traceCfg;
+    traceCfg.service = "evaluator";
+    if (const char* t = std::getenv("CC_EVAL_TRACE")) traceCfg.enabled = std::string(t) != "0";
+    traceCfg.capacity = env_size("CC_EVAL_TRACE_BUFFER", 4096);
+    if (const char* p = std::getenv("CC_EVAL_TRACE_FILE")) traceCfg.file = p;
+    trace::tracer().start(traceCfg);
+
+    // Pool de workers: limita cuántas compilaciones/ejecuciones corren a la vez
+    size_t hw = std::thread::hardware_concurrency();
+    const size_t nWorkers = env_size("CC_EVAL_WORKERS", hw ? hw : 2);
+    const size_t maxQueue = env_size("CC_EVAL_QUEUE", 64);
+    const size_t retryAfter = env_size("CC_EVAL_RETRY_AFTER", 5);
+
+    // Workspaces reciclados (en RAM si se puede), uno por worker
+    WorkspacePool::Config wsCfg;
+    if (const char* d = std::getenv("CC_EVAL_WORKSPACE_DIR")) wsCfg.base = d;
+    wsCfg.size = env_size("CC_EVAL_WORKSPACES", nWorkers);
+    wsCfg.quotaBytes = (uint64_t)env_size("CC_EVAL_WORKSPACE_QUOTA_MB", 64) * 1024 * 1024;
+    wsCfg.reapInterval = std::chrono::seconds(env_size("CC_EVAL_REAP_INTERVAL_S", 60));
+    wsCfg.reapAge = std::chrono::seconds(env_size("CC_EVAL_REAP_AGE_S", 600));
+    if (!WORKSPACES.start(wsCfg)) {
+        std::printf("[EV] No se pudo crear el directorio de workspaces en %s\n",
+            wsCfg.base.empty() ? "/dev/shm ni en el temporal" : wsCfg.base.string().c_str());
+        return 1;
+    }
+    COMPILE_LIMITS.fileBytes = (int64_t)wsCfg.quotaBytes;
+
+    WorkerPool pool(nWorkers, maxQueue);
+    SCALING_BUDGET_MS = (int64_t)env_size("CC_EVAL_SCALING_BUDGET_MS", 10000);
+    CASE_PARALLEL = env_size("CC_EVAL_CASE_PARALLEL", std::max<size_t>(1, (hw ? hw : 2) / 2));
+
+    // Almacén de submissions: expulsión por TTL/tamaño y log opcional en disco
+    SubmissionStore::Config storeCfg;
+    storeCfg.ttl = std::chrono::seconds(env_size("CC_EVAL_RESULT_TTL_S", 3600));
+    storeCfg.maxEntries = env_size("CC_EVAL_MAX_SUBMISSIONS", 10000);
+    if (const char* p = std::getenv("CC_EVAL_STORE_LOG")) storeCfg.logPath = p;
+    storeCfg.finalView = [&pool](const Submission& s) { return status_json(s, pool).dump(); };
+    STORE.start(storeCfg);
+
+    // Lo que quedó en cola o ejecutándose antes de reiniciar se vuelve a encolar
+    size_t resumed = 0;
+    for (const auto& sub : STORE.in_flight()) {
+        STORE.update(sub.id, [](Submission& s) { s.status = "queued"; });
+        if (!sub.source.empty() && enqueue(pool, sub) != WorkerPool::NO_TICKET) {
+            ++resumed;
+            continue;
+        }
+        STORE.update(sub.id, [](Submission& s) {
+            s.status = "done";
+            s.errorMsg = "La evaluación se interrumpió por un reinicio del servicio";
+            });
+    }
+    if (resumed) std::printf("[EV] Reanudadas %zu submissions del log\n", resumed);
+
+    // Los streams SSE y los long-poll ocupan un hilo HTTP mientras esperan: por
+    // defecto uno por envío en curso (cola + workers) más margen para el resto
+    const size_t httpThreads = env_size("CC_EVAL_HTTP_THREADS", maxQueue + nWorkers + 32);
+    const size_t maxWaitMs = env_size("CC_EVAL_MAX_WAIT_MS", 30000);
+    MAX_WAITERS = env_size("CC_EVAL_MAX_WAITERS", httpThreads > 32 ? httpThreads - 32 : httpThreads / 2 + 1);
+    if (MAX_WAITERS >= httpThreads) MAX_WAITERS = httpThreads > 1 ? httpThreads - 1 : 1;
+    svr.new_task_queue = [httpThreads] { return new httplib::ThreadPool(httpThreads); };
+
+    // Métricas leídas al vuelo de componentes que ya llevan la cuenta
+    auto& reg = metrics::registry();
+    reg.gauge_fn("cc_eval_pool_workers", "Workers del pool", [&pool] { return (double)pool.workers(); });
+    reg.gauge_fn("cc_eval_pool_active", "Workers ocupados", [&pool] { return (double)pool.active(); });
+    reg.gauge_fn("cc_eval_queue_depth", "Envíos esperando en la cola", [&pool] { return (double)pool.queued(); });
+    reg.gauge_fn("cc_eval_queue_capacity", "Capacidad de la cola", [&pool] { return (double)pool.capacity(); });
+    reg.gauge_fn("cc_eval_submissions_stored", "Envíos en memoria", [] { return (double)STORE.size(); });
+    reg.gauge_fn("cc_eval_http_waiters", "Streams SSE y long-polls esperando", [] { return (double)WAITERS.load(); });
+    reg.gauge_fn("cc_eval_http_threads", "Hilos HTTP configurados", [httpThreads] { return (double)httpThreads; });
+    reg.counter_fn("cc_eval_compile_cache_hits_total", "Aciertos de la caché de compilación",
+        [] { return (double)CACHE.stats().hits; });
+    reg.counter_fn("cc_eval_compile_cache_misses_total", "Fallos de la caché de compilación",
+        [] { return (double)CACHE.stats().misses; });
+    reg.counter_fn("cc_eval_compile_cache_evictions_total", "Expulsiones de la caché de compilación",
+        [] { return (double)CACHE.stats().evictions; });
+    reg.gauge_fn("cc_eval_compile_cache_bytes", "Bytes en la caché de compilación",
+        [] { return (double)CACHE.stats().bytes; });
+    reg.gauge_fn("cc_eval_workspaces", "Workspaces del pool", [] { return (double)WORKSPACES.stats().size; });
+    reg.gauge_fn("cc_eval_workspaces_in_use", "Workspaces prestados a un envío",
+        [] { return (double)WORKSPACES.stats().inUse; });
+    reg.counter_fn("cc_eval_workspace_waits_total", "Envíos que esperaron a un workspace libre",
+        [] { return (double)WORKSPACES.stats().waits; });
+    reg.counter_fn("cc_eval_workspace_over_quota_total", "Workspaces devueltos por encima de la cuota",
+        [] { return (double)WORKSPACES.stats().overQuota; });
+    reg.counter_fn("cc_eval_workspace_reaped_total", "Directorios cc_eval_* huérfanos borrados",
+        [] { return (double)WORKSPACES.stats().reaped; });
+    metrics::register_process_metrics(reg);
+    metrics::instrument(svr, reg, trace::record_request);
+    trace::serve_traces(svr);
+
     svr.Options(R"(/.*)", [](const httplib::Request&, httplib::Response& res) {
         set_cors(res);
         res.status = 200;
         });
 
+    // Health check con estado del pool y de la caché de compilación
+    svr.Get("/health", [&pool, httpThreads](const httplib::Request&, httplib::Response& res) {
+        set_cors(res);
+        auto cs = CACHE.stats();
+        auto ws = WORKSPACES.stats();
+        json profiles = json::object();
+        for (const auto& [name, prof] : PRE.profiles) {
+            profiles[name] = { {"flags", prof.flags}, {"pch", prof.pch} };
+        }
+        json compiler = {
+            {"path", PRE.compiler},
+            {"version", PRE.version},
+            {"warmupMs", PRE.warmupMs},
+            {"defaultProfile", PRE.defaultProfile},
+            {"profiles", std::move(profiles)}
+        };
+        uint64_t lookups = cs.hits + cs.misses;
+        json out = {
+            {"ok", !PRE.compiler.empty()},
+            {"service", "evaluator-cpp"},
+            {"compiler", compiler},
+            {"counters", {
+                {"source", PERF_COUNTERS ? "perf" : "rusage"},
+                {"note", PERF_COUNTERS_NOTE}
+            }},
+            {"pool", {
+                {"workers", pool.workers()},
+                {"active", pool.active()},
+                {"queued", pool.queued()},
+                {"capacity", pool.capacity()}
+            }},
+            {"http", {
+                {"threads", httpThreads},
+                {"waiters", WAITERS.load()},
+                {"maxWaiters", MAX_WAITERS}
+            }},
+            {"submissions", STORE.size()},
+            {"compileCache", {
+                {"hits", cs.hits},
+                {"misses", cs.misses},
+                {"hitRate", lookups ? (double)cs.hits / (double)lookups : 0.0},
+                {"evictions", cs.evictions},
+                {"entries", cs.entries},
+                {"bytes", cs.bytes},
+                {"maxBytes", cs.maxBytes}
+            }},
+            {"workspaces", {
+                {"root", ws.root},
+                {"ramBacked", ws.ramBacked},
+                {"size", ws.size},
+                {"inUse", ws.inUse},
+                {"retired", ws.retired},
+                {"leases", ws.leases},
+                {"waits", ws.waits},
+                {"overQuota", ws.overQuota},
+                {"scrubFailures", ws.scrubFailures},
+                {"reaped", ws.reaped}
+            }}
+        };
+        res.set_content(out.dump(), "application/json");
+        });
+
     // Crear submission
-    svr.Post("/submissions", [](const httplib::Request& req, httplib::Response& res) {
+    svr.Post("/submissions", [&pool, retryAfter](const httplib::Request& req, httplib::Response& res) {
         set_cors(res);
 
         json body;
@@ -424,48 +1294,128 @@ int main() {
             return;
         }
 
-        auto id = rand_id();
-        {
-            std::lock_guard<std::mutex> lk(DBM);
-            DB[id] = Submission{ id, "queued" };
+        Submission sub;
+        sub.id = rand_id();
+        sub.status = "queued";
+        sub.problemId = pid;
+        sub.source = src;
+        sub.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
+        sub.measureComplexity = body.value("measureComplexity", false);
+        const std::string id = sub.id;
+        STORE.put(sub);
+
+        if (enqueue(pool, sub, trace::request_context(req)) == WorkerPool::NO_TICKET) {
+            STORE.erase(id);
+            res.status = 503;
+            res.set_header("Retry-After", std::to_string(retryAfter));
+            json err = { {"error", "queue full"}, {"retryAfter", retryAfter} };
+            res.set_content(err.dump(), "application/json");
+            return;
         }
 
-        std::thread([id, pid, src]() {
-            {
-                std::lock_guard<std::mutex> lk(DBM);
-                DB[id].status = "running";
-            }
-            run_pipeline(id, src, pid);
-            }).detach();
-
         json out = { {"submissionId", id} };
         res.set_content(out.dump(), "application/json");
         });
 
     // Consultar submission
-    svr.Get(R"(/submissions/([A-Za-z0-9\-]+))", [](const httplib::Request& req, httplib::Response& res) {
+    svr.Get(R"(/submissions/([A-Za-z0-9\-]+))", [&pool, maxWaitMs](const httplib::Request& req, httplib::Response& res) {
         set_cors(res);
         auto id = req.matches[1].str();
 
-        std::lock_guard<std::mutex> lk(DBM);
-        auto it = DB.find(id);
-        if (it == DB.end()) {
+        // Long-poll: ?since=<version>&wait=<ms> responde en cuanto haya una
+        // versión más nueva que `since` o al vencer el plazo
+        uint64_t since = 0;
+        long long waitMs = 0;
+        try {
+            if (req.has_param("since")) since = std::stoull(req.get_param_value("since"));
+            if (req.has_param("wait")) waitMs = std::stoll(req.get_param_value("wait"));
+        }
+        catch (...) {
+            res.status = 400;
+            res.set_content(R"({"error":"invalid params"})", "application/json");
+            return;
+        }
+        waitMs = std::clamp<long long>(waitMs, 0, (long long)maxWaitMs);
+        // Sin hilo de espera disponible se contesta con el estado actual
+        const bool waiting = waitMs > 0 && acquire_waiter();
+        if (!waiting) waitMs = 0;
+
+        std::shared_ptr<const std::string> body;
+        bool found = STORE.wait_read(id, since, std::chrono::milliseconds(waitMs),
+            [&](const Submission& s) {
+                body = s.view ? s.view : std::make_shared<const std::string>(status_json(s, pool).dump());
+            });
+        if (waiting) release_waiter();
+        if (!found) {
             res.status = 404;
             res.set_content(R"({"error":"not found"})", "application/json");
             return;
         }
+        // Se envía desde el buffer compartido, sin copiarlo a la respuesta
+        res.set_content_provider(body->size(), "application/json",
+            [body](size_t offset, size_t length, httplib::DataSink& sink) {
+                return sink.write(body->data() + offset, length);
+            });
+        });
 
-        const auto& s = it->second;
-        json out = {
-            {"status", s.status},
-            {"results", s.results},
-            {"timeMs", s.timeMs},
-            {"memoryKB", s.memoryKB}
+    // Stream SSE: un evento "status" por cada transición
+    // (queued -> compiling -> running caso k -> done) y se cierra al terminar
+    svr.Get(R"(/submissions/([A-Za-z0-9\-]+)/events)", [&pool](const httplib::Request& req, httplib::Response& res) {
+        set_cors(res);
+        auto id = req.matches[1].str();
+        if (!STORE.read(id, [](const Submission&) {})) {
+            res.status = 404;
+            res.set_content(R"({"error":"not found"})", "application/json");
+            return;
+        }
+        if (!acquire_waiter()) {
+            res.status = 503;
+            res.set_header("Retry-After", "2");
+            res.set_content(R"({"error":"too many streams, use long-poll"})", "application/json");
+            return;
+        }
+
+        struct StreamState {
+            uint64_t sent = 0;        // versión ya enviada
+            int64_t position = -1;    // posición en cola ya enviada
+            bool finished = false;
         };
-        if (!s.errorMsg.empty()) out["note"] = s.errorMsg;
-        res.set_content(out.dump(), "application/json");
+        auto st = std::make_shared<StreamState>();
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no");
+        res.set_chunked_content_provider("text/event-stream",
+            [id, st, &pool](size_t, httplib::DataSink& sink) {
+                if (st->finished) {
+                    sink.done();
+                    return true;
+                }
+                // Mientras está en cola se despierta cada segundo para avisar si avanzó
+                bool queued = st->position >= 0;
+                auto timeout = queued ? std::chrono::milliseconds(1000) : std::chrono::milliseconds(15000);
+
+                std::string event;
+                bool found = STORE.wait_read(id, st->sent, timeout, [&](const Submission& s) {
+                    int64_t pos = s.status == "queued" ? (int64_t)pool.position(s.ticket) : -1;
+                    if (s.version == st->sent && pos == st->position) return;
+                    st->sent = s.version;
+                    st->position = pos;
+                    st->finished = s.status == "done";
+                    event = "id: " + std::to_string(s.version) + "\nevent: status\ndata: "
+                        + (s.view ? *s.view : status_json(s, pool).dump()) + "\n\n";
+                    });
+                if (!found) {
+                    sink.done();
+                    return true;
+                }
+                if (event.empty()) event = ": ping\n\n";   // mantiene viva la conexión
+                return sink.write(event.data(), event.size());
+            },
+            [](bool) { release_waiter(); });
         });
 
+    std::printf("[EV] Workers: %zu, cola máxima: %zu\n", nWorkers, maxQueue);
+    std::printf("[EV] Workspaces: %zu en %s%s\n", wsCfg.size, WORKSPACES.stats().root.c_str(),
+        WORKSPACES.stats().ramBacked ? " (tmpfs)" : "");
     std::printf("[EV] Escuchando en http://0.0.0.0:8082\n");
     svr.listen("0.0.0.0", 8082);
     return 0;
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "json.hpp"
+
+// ======================= OUTPUT CHECKER ========================
+// Compara la salida del programa con la esperada a medida que llega, sin
+// guardarla entera. Lo que el estudiante imprima antes del resultado solo se
+// cuenta. La línea de resultado, que el driver marca con RESULT_MARK, se
+// compara byte a byte contra el texto esperado. En cuanto aparece una
+// diferencia, feed() devuelve false y quien ejecuta puede matar el proceso.
+//
+// Modos:
+//   exact       bytes idénticos
+//   whitespace  ignora espacios fuera de las cadenas
+//   float       como whitespace; además, si un número tiene decimales o
+//               exponente, se compara con tolerancia `eps` (relativa, o
+//               absoluta por debajo de 1). Los enteros se comparan exactos.
+//
+// De lo obtenido solo se guardan los primeros `keep` bytes (para mostrarlos),
+// en un buffer reservado al construir: feed() no reserva memoria.
+class OutputChecker {
+public:
+    enum class Mode { Exact, Whitespace, Float };
+
+    struct Spec {
+        Mode mode = Mode::Float;
+        double eps = 1e-6;
+    };
+
+    static constexpr char RESULT_MARK = '\x1e';
+
+    // "checker" del problema: { "mode": "exact" | "whitespace" | "float", "tolerance": 1e-6 }
+    static Spec parse_spec(const nlohmann::json& j) {
+        Spec s;
+        if (!j.is_object()) return s;
+        const std::string mode = j.value("mode", "float");
+        if (mode == "exact") s.mode = Mode::Exact;
+        else if (mode == "whitespace") s.mode = Mode::Whitespace;
+        else if (mode != "float") throw std::runtime_error("checker.mode desconocido: " + mode);
+        s.eps = j.value("tolerance", s.eps);
+        return s;
+    }
+
+    OutputChecker(const std::string& expected, const Spec& spec, size_t keep = 4096)
+        : exp_(expected), spec_(spec), keep_(keep) {
+        shown_.reserve(keep_);
+    }
+
+    // Procesa un trozo de stdout; false en cuanto la salida ya no puede coincidir
+    bool feed(const char* p, size_t n) {
+        size_t i = 0;
+        if (state_ == State::Scan) {
+            const void* m = std::memchr(p, RESULT_MARK, n);
+            if (!m) {
+                traceBytes_ += n;
+                return true;
+            }
+            i = (size_t)((const char*)m - p);
+            traceBytes_ += i;
+            ++i;
+            state_ = State::Result;
+        }
+        for (; i < n && state_ == State::Result; ++i) {
+            const char c = p[i];
+            if (c == '\r') continue;
+            if (c == '\n') {
+                finish();
+                break;
+            }
+            if (shown_.size() < keep_) shown_.push_back(c);
+            if (!step(c)) state_ = State::Mismatch;
+        }
+        return state_ != State::Mismatch;
+    }
+
+    // Al terminar el proceso: true si apareció la línea de resultado y coincidió
+    bool matched() const {
+        if (state_ == State::Done) return true;
+        if (state_ != State::Result) return false;
+        // Sin salto de línea final: se cierra aquí (sobre una copia, es const)
+        OutputChecker tail = *this;
+        tail.finish();
+        return tail.state_ == State::Done;
+    }
+
+    bool found_result() const { return state_ != State::Scan; }
+    const std::string& shown() const { return shown_; }
+    uint64_t trace_bytes() const { return traceBytes_; }
+
+private:
+    enum class State { Scan, Result, Done, Mismatch };
+
+    static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\f' || c == '\v'; }
+    static bool num_start(char c) { return c == '-' || (c >= '0' && c <= '9'); }
+    static bool num_char(char c) {
+        return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-';
+    }
+
+    void skip_expected_space() {
+        while (pos_ < exp_.size() && (is_space(exp_[pos_]) || exp_[pos_] == '\n' || exp_[pos_] == '\r')) ++pos_;
+    }
+
+    // Un byte de la línea de resultado
+    bool step(char c) {
+        if (spec_.mode == Mode::Exact) return pos_ < exp_.size() && exp_[pos_++] == c;
+
+        if (numLen_ > 0) {
+            if (num_char(c)) {
+                if (numLen_ + 1 >= sizeof(num_)) return false;
+                num_[numLen_++] = c;
+                return true;
+            }
+            if (!close_number()) return false;
+        }
+        if (inString_) {
+            if (escape_) escape_ = false;
+            else if (c == '\\') escape_ = true;
+            else if (c == '"') inString_ = false;
+            return pos_ < exp_.size() && exp_[pos_++] == c;
+        }
+        if (is_space(c)) return true;
+        skip_expected_space();
+        if (spec_.mode == Mode::Float && num_start(c)) {
+            num_[numLen_++] = c;
+            return true;
+        }
+        if (c == '"') inString_ = true;
+        return pos_ < exp_.size() && exp_[pos_++] == c;
+    }
+
+    // Compara el número acumulado con el que toca en el texto esperado
+    bool close_number() {
+        num_[numLen_] = '\0';
+        const char* e = exp_.c_str() + pos_;
+        char* eEnd = nullptr;
+        char* gEnd = nullptr;
+        const double want = std::strtod(e, &eEnd);
+        const double got = std::strtod(num_, &gEnd);
+        const size_t eLen = (size_t)(eEnd - e);
+        const size_t gLen = numLen_;
+        numLen_ = 0;
+        if (eLen == 0 || gEnd != num_ + gLen) return false;
+        pos_ += eLen;
+
+        auto integral = [](const char* s, size_t len) {
+            for (size_t k = 0; k < len; ++k) {
+                if (s[k] == '.' || s[k] == 'e' || s[k] == 'E') return false;
+            }
+            return true;
+        };
+        if (integral(e, eLen) && integral(num_, gLen)) {
+            return std::strtoll(e, nullptr, 10) == std::strtoll(num_, nullptr, 10);
+        }
+        return std::fabs(got - want) <= spec_.eps * std::max(1.0, std::fabs(want));
+    }
+
+    void finish() {
+        bool ok = true;
+        if (spec_.mode != Mode::Exact) {
+            if (numLen_ > 0) ok = close_number();
+            skip_expected_space();
+        }
+        state_ = ok && !inString_ && pos_ == exp_.size() ? State::Done : State::Mismatch;
+    }
+
+    const std::string& exp_;
+    Spec spec_;
+    size_t keep_;
+
+    State state_ = State::Scan;
+    size_t pos_ = 0;                 // cursor en el texto esperado
+    bool inString_ = false;
+    bool escape_ = false;
+    char num_[64];                   // número en curso (modo float)
+    size_t numLen_ = 0;
+    std::string shown_;
+    uint64_t traceBytes_ = 0;
+};
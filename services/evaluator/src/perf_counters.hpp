@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// ===================== CONTADORES HARDWARE =====================
+// Instrucciones, ciclos, fallos de caché y de predicción de saltos de un
+// proceso hijo vía perf_event_open. A diferencia del tiempo, las
+// instrucciones retiradas apenas dependen de la carga de la máquina, así que
+// sirven para comparar la eficiencia de dos envíos.
+// Los contadores se abren sobre el hijo antes de su exec() con enable_on_exec
+// (solo cuentan el programa, no el fork) e inherit (también sus hilos), y
+// solo en modo usuario: con perf_event_paranoid <= 2 no hace falta root.
+// Sin PMU (muchas VMs) o sin permiso probe() lo dice y quien llama se queda
+// con el tiempo de CPU de rusage.
+
+namespace perf_counters {
+
+struct Counters {
+    bool valid = false;          // al menos instrucciones y ciclos
+    bool scaled = false;         // el kernel multiplexó y los valores son estimados
+    int64_t instructions = -1;   // -1 = no disponible
+    int64_t cycles = -1;
+    int64_t cacheMisses = -1;
+    int64_t branchMisses = -1;
+};
+
+#ifdef __linux__
+
+namespace detail {
+inline int open_event(uint64_t config, pid_t pid, bool onExec) {
+    struct perf_event_attr a;
+    std::memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.type = PERF_TYPE_HARDWARE;
+    a.config = config;
+    a.disabled = 1;
+    a.enable_on_exec = onExec ? 1 : 0;
+    a.inherit = 1;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &a, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+inline int paranoid() {
+    int v = -100;
+    if (FILE* f = std::fopen("/proc/sys/kernel/perf_event_paranoid", "r")) {
+        if (std::fscanf(f, "%d", &v) != 1) v = -100;
+        std::fclose(f);
+    }
+    return v;
+}
+}
+
+// Comprueba una vez si se pueden contar instrucciones; si no, deja el motivo en `why`
+inline bool probe(std::string& why) {
+    int fd = detail::open_event(PERF_COUNT_HW_INSTRUCTIONS, 0, false);
+    if (fd >= 0) {
+        close(fd);
+        return true;
+    }
+    const int e = errno;
+    if (e == ENOENT || e == EOPNOTSUPP) why = "sin PMU de hardware";
+    else if (e == EACCES || e == EPERM) why = "sin permiso (perf_event_paranoid=" + std::to_string(detail::paranoid()) + ")";
+    else if (e == ENOSYS) why = "perf_event_open no disponible";
+    else why = std::strerror(e);
+    return false;
+}
+
+// Contadores abiertos sobre un proceso que aún no ha hecho exec()
+class Group {
+public:
+    Group() = default;
+    Group(const Group&) = delete;
+    Group& operator=(const Group&) = delete;
+    ~Group() { close_all(); }
+
+    void open(pid_t pid) {
+        static const uint64_t events[N] = {
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int i = 0; i < N; ++i) fd_[i] = detail::open_event(events[i], pid, true);
+    }
+
+    // Tras wait4(): los valores finales siguen disponibles en los descriptores
+    Counters read() {
+        Counters c;
+        int64_t* out[N] = { &c.instructions, &c.cycles, &c.cacheMisses, &c.branchMisses };
+        for (int i = 0; i < N; ++i) {
+            if (fd_[i] < 0) continue;
+            uint64_t v[3] = { 0, 0, 0 };   // valor, tiempo habilitado, tiempo contando
+            if (::read(fd_[i], v, sizeof(v)) != (ssize_t)sizeof(v) || v[2] == 0) continue;
+            if (v[2] < v[1]) {
+                v[0] = (uint64_t)((double)v[0] * (double)v[1] / (double)v[2]);
+                c.scaled = true;
+            }
+            *out[i] = (int64_t)v[0];
+        }
+        c.valid = c.instructions >= 0 && c.cycles >= 0;
+        close_all();
+        return c;
+    }
+
+private:
+    static constexpr int N = 4;
+
+    void close_all() {
+        for (int& fd : fd_) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    }
+
+    int fd_[N] = { -1, -1, -1, -1 };
+};
+
+#else
+
+inline bool probe(std::string& why) {
+    why = "solo disponible en Linux";
+    return false;
+}
+
+class Group {
+public:
+    void open(long) {}
+    Counters read() { return Counters(); }
+};
+
+#endif
+
+} // namespace perf_counters
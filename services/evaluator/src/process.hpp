@@ -0,0 +1,578 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "perf_counters.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// ======================= PROCESOS ==============================
+// Lanza un proceso sin pasar por /bin/sh: argv explícito, directorio de
+// trabajo fijado en el hijo y stdout/stderr capturados por pipes en memoria.
+// En Windows: CreateProcess con ficheros temporales y un Job Object.
+
+// Límites por ejecución. 0 = sin límite.
+struct ProcLimits {
+    int64_t cpuMs = 0;          // RLIMIT_CPU (redondeado a segundos) + chequeo por rusage
+    int64_t wallMs = 0;         // se mata al grupo de procesos al vencer
+    int64_t memoryKB = 0;       // RLIMIT_AS
+    int64_t outputBytes = 0;    // stdout + stderr capturados
+    int64_t fileBytes = 0;      // RLIMIT_FSIZE para ficheros escritos por el proceso
+    int64_t openFiles = 0;      // RLIMIT_NOFILE (descriptores abiertos a la vez)
+};
+
+struct ProcSpec {
+    std::vector<std::string> argv;   // argv[0] es el ejecutable
+    std::filesystem::path cwd;       // vacío = directorio actual
+    std::string stdinData;           // se escribe completo en stdin del hijo
+    ProcLimits limits;
+    // Si se indica, stdout no se acumula en `out`: cada trozo se entrega aquí
+    // según llega y, si devuelve false, se mata al proceso (ProcResult::stopped)
+    std::function<bool(const char*, size_t)> onStdout;
+    bool counters = false;           // medir contadores hardware (ver perf_counters.hpp)
+    // Si se indica, se consulta cada `checkMs` mientras el proceso vive y, si
+    // devuelve false, se mata al grupo (ProcResult::quotaExceeded). El pipeline
+    // vigila así la cuota de disco del workspace durante la ejecución.
+    std::function<bool()> withinQuota;
+    int64_t checkMs = 100;
+};
+
+struct ProcResult {
+    bool started = false;    // false si no se pudo lanzar (ver `error`)
+    int exitCode = -1;       // código de salida si terminó normalmente
+    int signal = 0;          // señal que lo terminó (solo POSIX)
+    std::string out;
+    std::string err;
+    int64_t wallMs = 0;
+    int64_t userMs = 0;      // tiempo de CPU en modo usuario (rusage)
+    int64_t sysMs = 0;       // tiempo de CPU en modo kernel (rusage)
+    int64_t maxRssKB = 0;    // pico de memoria residente (rusage)
+    bool timedOut = false;       // se superó wallMs (o cpuMs) y se mató al proceso
+    bool outputExceeded = false; // se superó outputBytes y se mató al proceso
+    bool stopped = false;        // onStdout pidió parar y se mató al proceso
+    bool quotaExceeded = false;  // withinQuota devolvió false y se mató al proceso
+    perf_counters::Counters counters;   // solo si ProcSpec::counters y hay perf
+    std::string error;
+
+    int64_t cpuMs() const { return userMs + sysMs; }
+    bool ok() const { return started && signal == 0 && exitCode == 0; }
+};
+
+#ifdef _WIN32
+
+namespace proc_detail {
+inline std::string quote(const std::string& s) { return "\"" + s + "\""; }
+
+inline std::string slurp(const std::filesystem::path& p) {
+    std::ifstream f(p, std::ios::binary);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+// Ficheros de redirección propios de cada ejecución: los casos de un envío
+// corren en paralelo dentro del mismo workspace
+inline std::string unique_stem() {
+    static std::atomic<unsigned long long> seq{ 0 };
+    return "proc." + std::to_string(GetCurrentProcessId()) + "." + std::to_string(seq.fetch_add(1));
+}
+
+inline HANDLE open_inheritable(const std::filesystem::path& p, bool write) {
+    SECURITY_ATTRIBUTES sa = { sizeof(sa), nullptr, TRUE };
+    return CreateFileW(p.wstring().c_str(), write ? GENERIC_WRITE : GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE, &sa, write ? CREATE_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+}
+
+inline int64_t filetime_ms(const FILETIME& ft) {
+    ULARGE_INTEGER u;
+    u.LowPart = ft.dwLowDateTime;
+    u.HighPart = ft.dwHighDateTime;
+    return (int64_t)(u.QuadPart / 10000);   // unidades de 100 ns
+}
+
+inline int64_t file_size(HANDLE h) {
+    LARGE_INTEGER sz;
+    return GetFileSizeEx(h, &sz) ? (int64_t)sz.QuadPart : 0;
+}
+}
+
+// En Windows la redirección va por ficheros y los límites por un Job Object:
+// memoria y CPU los aplica el propio Job; plazo de pared y salida se vigilan
+// desde aquí y, al superarlos, se termina el Job entero (hijo y descendientes).
+inline ProcResult run_process(const ProcSpec& spec) {
+    namespace fs = std::filesystem;
+    ProcResult r;
+    if (spec.argv.empty()) {
+        r.error = "argv vacío";
+        return r;
+    }
+
+    fs::path dir = spec.cwd.empty() ? fs::current_path() : spec.cwd;
+    const std::string stem = proc_detail::unique_stem();
+    fs::path inF = dir / (stem + ".in"), outF = dir / (stem + ".out"), errF = dir / (stem + ".err");
+    {
+        std::ofstream f(inF, std::ios::binary);
+        f << spec.stdinData;
+    }
+    auto cleanup = [&]() {
+        std::error_code ec;
+        fs::remove(inF, ec);
+        fs::remove(outF, ec);
+        fs::remove(errF, ec);
+    };
+
+    HANDLE hIn = proc_detail::open_inheritable(inF, false);
+    HANDLE hOut = proc_detail::open_inheritable(outF, true);
+    HANDLE hErr = proc_detail::open_inheritable(errF, true);
+    auto close_files = [&]() {
+        for (HANDLE h : { hIn, hOut, hErr }) {
+            if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+        }
+    };
+    if (hIn == INVALID_HANDLE_VALUE || hOut == INVALID_HANDLE_VALUE || hErr == INVALID_HANDLE_VALUE) {
+        r.error = "no se pudieron crear los ficheros de redirección";
+        close_files();
+        cleanup();
+        return r;
+    }
+
+    // CreateProcess busca un ejecutable relativo en el directorio del padre, no en cwd
+    std::string app;
+    fs::path exe = spec.argv[0];
+    if (exe.is_relative() && fs::exists(dir / exe)) app = (dir / exe).string();
+    std::string cmd;
+    for (const auto& a : spec.argv) cmd += (cmd.empty() ? "" : " ") + proc_detail::quote(a);
+
+    HANDLE job = CreateJobObjectA(nullptr, nullptr);
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION lim = {};
+    lim.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    if (spec.limits.memoryKB > 0) {
+        lim.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+        lim.ProcessMemoryLimit = (SIZE_T)spec.limits.memoryKB * 1024;
+    }
+    if (spec.limits.cpuMs > 0) {
+        lim.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_JOB_TIME;
+        lim.BasicLimitInformation.PerJobUserTimeLimit.QuadPart = spec.limits.cpuMs * 10000;
+    }
+    if (job) SetInformationJobObject(job, JobObjectExtendedLimitInformation, &lim, sizeof(lim));
+
+    STARTUPINFOA si = {};
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = hIn;
+    si.hStdOutput = hOut;
+    si.hStdError = hErr;
+    PROCESS_INFORMATION pi = {};
+    std::string cwd = dir.string();
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!CreateProcessA(app.empty() ? nullptr : app.c_str(), &cmd[0], nullptr, nullptr, TRUE,
+        CREATE_SUSPENDED | CREATE_NO_WINDOW, nullptr, cwd.c_str(), &si, &pi)) {
+        r.error = "no se pudo ejecutar " + spec.argv[0] + " (error " + std::to_string(GetLastError()) + ")";
+        if (job) CloseHandle(job);
+        close_files();
+        cleanup();
+        return r;
+    }
+    if (job) AssignProcessToJobObject(job, pi.hProcess);
+    ResumeThread(pi.hThread);
+    CloseHandle(pi.hThread);
+
+    const int64_t wallLimit = spec.limits.wallMs;
+    const int64_t outLimit = spec.limits.outputBytes;
+    auto kill_job = [&]() {
+        if (job) TerminateJobObject(job, 1);
+        else TerminateProcess(pi.hProcess, 1);
+        WaitForSingleObject(pi.hProcess, INFINITE);
+    };
+    for (;;) {
+        DWORD w = WaitForSingleObject(pi.hProcess, 50);
+        if (w != WAIT_TIMEOUT) break;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (wallLimit > 0 && elapsed >= wallLimit) {
+            r.timedOut = true;
+            kill_job();
+            break;
+        }
+        if (outLimit > 0 && proc_detail::file_size(hOut) + proc_detail::file_size(hErr) > outLimit) {
+            r.outputExceeded = true;
+            kill_job();
+            break;
+        }
+        if (spec.withinQuota && !spec.withinQuota()) {
+            r.quotaExceeded = true;
+            kill_job();
+            break;
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    DWORD code = 0;
+    GetExitCodeProcess(pi.hProcess, &code);
+    FILETIME c0, e0, kt, ut;
+    if (GetProcessTimes(pi.hProcess, &c0, &e0, &kt, &ut)) {
+        r.userMs = proc_detail::filetime_ms(ut);
+        r.sysMs = proc_detail::filetime_ms(kt);
+    }
+    if (job) {
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION info = {};
+        if (QueryInformationJobObject(job, JobObjectExtendedLimitInformation, &info, sizeof(info), nullptr)) {
+            r.maxRssKB = (int64_t)(info.PeakProcessMemoryUsed / 1024);   // memoria comprometida
+        }
+        CloseHandle(job);
+    }
+    CloseHandle(pi.hProcess);
+    const int64_t written = proc_detail::file_size(hOut) + proc_detail::file_size(hErr);
+    close_files();
+
+    r.started = true;
+    r.exitCode = (int)code;
+    r.wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    if (spec.limits.cpuMs > 0 && r.cpuMs() >= spec.limits.cpuMs) r.timedOut = true;
+    if (outLimit > 0 && written > outLimit) r.outputExceeded = true;
+    r.out = proc_detail::slurp(outF);
+    r.err = proc_detail::slurp(errF);
+    if (spec.onStdout) {
+        // Sin pipes no hay forma de cortar antes: se entrega todo al final
+        r.stopped = !spec.onStdout(r.out.data(), r.out.size());
+        r.out.clear();
+    }
+    cleanup();
+    return r;
+}
+
+#else
+
+namespace proc_detail {
+// Cierra todo descriptor heredado (sockets del servidor, etc.) excepto 0-2 y `keep`.
+// Solo usa llamadas async-signal-safe: se ejecuta entre fork() y exec().
+inline void close_inherited_fds(int keep) {
+#ifdef SYS_close_range
+    // Linux >= 5.9: una sola llamada en vez de recorrer todos los descriptores
+    bool ok = true;
+    if (keep > 3) ok = syscall(SYS_close_range, 3u, (unsigned)keep - 1, 0u) == 0;
+    if (ok && syscall(SYS_close_range, (unsigned)keep + 1, ~0u, 0u) == 0) return;
+#endif
+    struct rlimit rl;
+    int maxFd = 1024;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+        maxFd = rl.rlim_cur > 65536 ? 65536 : (int)rl.rlim_cur;
+    }
+    for (int fd = 3; fd < maxFd; ++fd) {
+        if (fd != keep) close(fd);
+    }
+}
+
+inline void apply_limit(int resource, rlim_t soft, rlim_t hard) {
+    struct rlimit rl;
+    rl.rlim_cur = soft;
+    rl.rlim_max = hard;
+    setrlimit(resource, &rl);
+}
+
+// Se ejecuta en el hijo antes de exec(): solo llamadas async-signal-safe.
+inline void apply_limits(const ProcLimits& lim) {
+    if (lim.cpuMs > 0) {
+        // RLIMIT_CPU va en segundos: se redondea hacia arriba y el padre
+        // compara luego el tiempo exacto de rusage contra cpuMs.
+        // El límite duro va un segundo después para que llegue SIGXCPU y no SIGKILL.
+        rlim_t sec = (rlim_t)((lim.cpuMs + 999) / 1000);
+        apply_limit(RLIMIT_CPU, sec, sec + 1);
+    }
+    if (lim.memoryKB > 0) {
+        rlim_t bytes = (rlim_t)lim.memoryKB * 1024;
+        apply_limit(RLIMIT_AS, bytes, bytes);
+    }
+    if (lim.fileBytes > 0) {
+        apply_limit(RLIMIT_FSIZE, (rlim_t)lim.fileBytes, (rlim_t)lim.fileBytes);
+    }
+    if (lim.openFiles > 0) {
+        apply_limit(RLIMIT_NOFILE, (rlim_t)lim.openFiles, (rlim_t)lim.openFiles);
+    }
+    apply_limit(RLIMIT_CORE, 0, 0);
+}
+
+inline int64_t tv_ms(const struct timeval& tv) {
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+inline void set_nonblock(int fd) {
+    int fl = fcntl(fd, F_GETFL);
+    if (fl >= 0) fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+}
+}
+
+inline ProcResult run_process(const ProcSpec& spec) {
+    ProcResult r;
+    if (spec.argv.empty()) {
+        r.error = "argv vacío";
+        return r;
+    }
+
+    // Preparar todo lo que el hijo necesita antes de fork(): tras fork()
+    // en un proceso con hilos el hijo no debe reservar memoria.
+    std::vector<char*> argv;
+    argv.reserve(spec.argv.size() + 1);
+    for (const auto& a : spec.argv) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+    std::string cwd = spec.cwd.string();
+
+    int inP[2], outP[2], errP[2], execP[2];
+    if (pipe2(inP, O_CLOEXEC) != 0) { r.error = std::strerror(errno); return r; }
+    if (pipe2(outP, O_CLOEXEC) != 0) {
+        r.error = std::strerror(errno);
+        close(inP[0]); close(inP[1]);
+        return r;
+    }
+    if (pipe2(errP, O_CLOEXEC) != 0) {
+        r.error = std::strerror(errno);
+        close(inP[0]); close(inP[1]); close(outP[0]); close(outP[1]);
+        return r;
+    }
+    // Pipe para reportar un fallo de chdir/exec; se cierra solo si exec tiene éxito
+    if (pipe2(execP, O_CLOEXEC) != 0) {
+        r.error = std::strerror(errno);
+        close(inP[0]); close(inP[1]); close(outP[0]); close(outP[1]);
+        close(errP[0]); close(errP[1]);
+        return r;
+    }
+
+    // Con contadores, el hijo espera en este pipe a que el padre los abra sobre él
+    int gateP[2] = { -1, -1 };
+    if (spec.counters && pipe2(gateP, O_CLOEXEC) != 0) gateP[0] = gateP[1] = -1;
+
+    auto t0 = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        r.error = std::strerror(errno);
+        for (int fd : { inP[0], inP[1], outP[0], outP[1], errP[0], errP[1], execP[0], execP[1] }) close(fd);
+        for (int fd : gateP) if (fd >= 0) close(fd);
+        return r;
+    }
+
+    if (pid == 0) {
+        // ---- Hijo ----
+        // Grupo de procesos propio para poder matar también a sus descendientes
+        setpgid(0, 0);
+        if (gateP[0] >= 0) {
+            close(gateP[1]);
+            char go;
+            while (read(gateP[0], &go, 1) < 0 && errno == EINTR) {}
+        }
+        dup2(inP[0], STDIN_FILENO);
+        dup2(outP[1], STDOUT_FILENO);
+        dup2(errP[1], STDERR_FILENO);
+        proc_detail::close_inherited_fds(execP[1]);
+        signal(SIGPIPE, SIG_DFL);
+        proc_detail::apply_limits(spec.limits);
+
+        int e = 0;
+        if (!cwd.empty() && chdir(cwd.c_str()) != 0) {
+            e = errno;
+        }
+        else {
+            execvp(argv[0], argv.data());
+            e = errno;
+        }
+        ssize_t w = write(execP[1], &e, sizeof(e));
+        (void)w;
+        _exit(127);
+    }
+
+    // ---- Padre ----
+    setpgid(pid, pid);
+    close(inP[0]);
+    close(outP[1]);
+    close(errP[1]);
+    close(execP[1]);
+
+    perf_counters::Group counters;
+    if (gateP[0] >= 0) {
+        close(gateP[0]);
+        counters.open(pid);
+        close(gateP[1]);   // EOF: el hijo sigue hacia exec()
+    }
+
+    int childErr = 0;
+    ssize_t n = read(execP[0], &childErr, sizeof(childErr));
+    close(execP[0]);
+    if (n == (ssize_t)sizeof(childErr)) {
+        r.error = std::string("no se pudo ejecutar ") + spec.argv[0] + ": " + std::strerror(childErr);
+    }
+
+    proc_detail::set_nonblock(inP[1]);
+    proc_detail::set_nonblock(outP[0]);
+    proc_detail::set_nonblock(errP[0]);
+
+    int inFd = spec.stdinData.empty() ? -1 : inP[1];
+    if (inFd < 0) close(inP[1]);
+    int outFd = outP[0], errFd = errP[0];
+    size_t inOff = 0;
+    size_t captured = 0;     // stdout + stderr recibidos (entregados o acumulados)
+    char buf[16384];
+
+    const int64_t wallLimit = spec.limits.wallMs;
+    const size_t outLimit = (size_t)spec.limits.outputBytes;
+    auto kill_group = [&]() {
+        kill(-pid, SIGKILL);
+        kill(pid, SIGKILL);
+        for (int* fd : { &inFd, &outFd, &errFd }) {
+            if (*fd >= 0) close(*fd);
+            *fd = -1;
+        }
+    };
+    // Cuota del llamante: se consulta como mucho cada checkMs
+    const int64_t checkMs = spec.withinQuota ? (spec.checkMs > 0 ? spec.checkMs : 100) : 0;
+    int64_t nextCheck = checkMs;
+    auto quota_hit = [&](int64_t elapsed) {
+        if (!checkMs || elapsed < nextCheck) return false;
+        nextCheck = elapsed + checkMs;
+        if (spec.withinQuota()) return false;
+        r.quotaExceeded = true;
+        kill_group();
+        return true;
+    };
+
+    while (inFd >= 0 || outFd >= 0 || errFd >= 0) {
+        int timeout = -1;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (wallLimit > 0) {
+            if (elapsed >= wallLimit) {
+                r.timedOut = true;
+                kill_group();
+                break;
+            }
+            timeout = (int)(wallLimit - elapsed);
+        }
+        if (quota_hit(elapsed)) break;
+        if (checkMs && (timeout < 0 || nextCheck - elapsed < timeout)) timeout = (int)(nextCheck - elapsed);
+
+        struct pollfd fds[3];
+        int nf = 0;
+        if (outFd >= 0) fds[nf++] = { outFd, POLLIN, 0 };
+        if (errFd >= 0) fds[nf++] = { errFd, POLLIN, 0 };
+        if (inFd >= 0) fds[nf++] = { inFd, POLLOUT, 0 };
+        int pr = poll(fds, nf, timeout);
+        if (pr < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pr == 0) continue;   // se revisa el plazo al inicio del bucle
+        for (int i = 0; i < nf; ++i) {
+            if (!fds[i].revents) continue;
+            int fd = fds[i].fd;
+            if (fd == inFd) {
+                ssize_t w = write(fd, spec.stdinData.data() + inOff, spec.stdinData.size() - inOff);
+                if (w > 0) inOff += (size_t)w;
+                if ((w < 0 && errno != EAGAIN && errno != EINTR) || inOff >= spec.stdinData.size()) {
+                    close(inFd);
+                    inFd = -1;
+                }
+                continue;
+            }
+            ssize_t got = read(fd, buf, sizeof(buf));
+            if (got > 0) {
+                captured += (size_t)got;
+                if (outLimit > 0 && captured > outLimit) {
+                    r.outputExceeded = true;
+                    kill_group();
+                    break;
+                }
+                if (fd == outFd && spec.onStdout) {
+                    if (!spec.onStdout(buf, (size_t)got)) {
+                        r.stopped = true;
+                        kill_group();
+                        break;
+                    }
+                }
+                else (fd == outFd ? r.out : r.err).append(buf, (size_t)got);
+            }
+            else if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+                close(fd);
+                if (fd == outFd) outFd = -1; else errFd = -1;
+            }
+        }
+    }
+
+    for (int fd : { inFd, outFd, errFd }) {
+        if (fd >= 0) close(fd);
+    }
+
+    // wait4 da, además del estado, el uso real de CPU y el pico de RSS del hijo.
+    // El hijo puede haber cerrado stdout/stderr y seguir vivo: el plazo de
+    // pared (y la cuota) se aplica hasta recogerlo (esperando en un pidfd si lo hay).
+    int status = 0;
+    struct rusage ru {};
+    int pidFd = -1;
+    auto watching = [&] { return (wallLimit > 0 || checkMs) && !r.timedOut && !r.quotaExceeded; };
+#ifdef SYS_pidfd_open
+    if (watching()) pidFd = (int)syscall(SYS_pidfd_open, pid, 0u);
+#endif
+    for (;;) {
+        const bool bounded = watching();
+        pid_t w = wait4(pid, &status, bounded ? WNOHANG : 0, &ru);
+        if (w == pid) break;
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (wallLimit > 0 && elapsed >= wallLimit) {
+            r.timedOut = true;
+            kill_group();
+            continue;
+        }
+        if (quota_hit(elapsed)) continue;
+        int remaining = wallLimit > 0 ? (int)(wallLimit - elapsed) : (int)checkMs;
+        if (checkMs && nextCheck - elapsed < remaining) remaining = (int)(nextCheck - elapsed);
+        if (pidFd >= 0) {
+            struct pollfd pf = { pidFd, POLLIN, 0 };
+            poll(&pf, 1, remaining);
+        }
+        else {
+            usleep((useconds_t)(remaining < 5 ? remaining : 5) * 1000);
+        }
+    }
+    if (pidFd >= 0) close(pidFd);
+    auto t1 = std::chrono::steady_clock::now();
+
+    r.started = r.error.empty();
+    r.wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    r.userMs = proc_detail::tv_ms(ru.ru_utime);
+    r.sysMs = proc_detail::tv_ms(ru.ru_stime);
+    r.maxRssKB = ru.ru_maxrss;   // Linux: ya viene en KB
+    if (WIFEXITED(status)) r.exitCode = WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) r.signal = WTERMSIG(status);
+    if (r.signal == SIGXCPU || (spec.limits.cpuMs > 0 && r.cpuMs() > spec.limits.cpuMs)) {
+        r.timedOut = true;
+    }
+    if (r.signal == SIGXFSZ) r.outputExceeded = true;
+    if (spec.counters) r.counters = counters.read();
+    return r;
+}
+
+#endif
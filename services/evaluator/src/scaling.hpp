@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+#include "harness_gen.hpp"
+
+// ===================== MEDICIÓN EMPÍRICA =======================
+// Complejidad medida en vez de adivinada: tras un AC se generan entradas de
+// tamaño creciente, el driver cronometra la solución en modo medición (ver
+// harness_gen.hpp) y se ajusta la curva tiempo/n a cada modelo candidato.
+// El problema puede describir en "scaling" cómo generar la entrada:
+//   "scaling": { "sizes": [1000, ...], "expected": "O(n)", "budgetMs": 50,
+//                "params": { "target": "absent" | "n" | "random" | 42,
+//                            "nums": "sorted" | "random" | "reversed" | "constant" } }
+// Por defecto los vectores van ordenados y los enteros sueltos valen -1 (un
+// valor "que no está"), que suele ser el peor caso de búsquedas y sumas.
+
+namespace scaling {
+
+struct Spec {
+    std::vector<int> sizes = { 1000, 3000, 10000, 30000, 100000, 300000, 1000000 };
+    nlohmann::json params = nlohmann::json::object();   // estrategia por parámetro
+    std::string expected;                               // clase esperada ("" = sin dato)
+    int budgetMs = 50;                                  // tiempo de repeticiones por tamaño
+};
+
+inline Spec parse_spec(const nlohmann::json& j) {
+    Spec s;
+    if (!j.is_object()) return s;
+    if (j.contains("sizes") && j["sizes"].is_array()) {
+        std::vector<int> sizes;
+        for (const auto& v : j["sizes"]) {
+            if (v.is_number_integer() && v.get<long long>() > 0 && v.get<long long>() <= 10000000) {
+                sizes.push_back(v.get<int>());
+            }
+        }
+        if (!sizes.empty()) s.sizes = std::move(sizes);
+    }
+    if (j.contains("params") && j["params"].is_object()) s.params = j["params"];
+    s.expected = j.value("expected", std::string());
+    s.budgetMs = std::max(1, std::min(1000, j.value("budgetMs", s.budgetMs)));
+    return s;
+}
+
+// ---------------- Generación de entradas ----------------
+
+inline nlohmann::json gen_scalar(const harness_gen::Type& t, long long i, std::mt19937& rng,
+    const std::string& mode) {
+    using harness_gen::Type;
+    switch (t.kind) {
+    case Type::Int:
+    case Type::Long:
+        if (mode == "random") return (long long)(rng() % 1000000000u);
+        if (mode == "constant") return 1;
+        if (mode == "reversed") return -2 * i;
+        return 2 * i;   // sorted
+    case Type::Double:
+        if (mode == "random") return std::uniform_real_distribution<double>(0, 1)(rng);
+        return 0.5 * (double)i;
+    case Type::Bool:
+        return mode == "random" ? (rng() & 1) != 0 : (i & 1) != 0;
+    case Type::Char:
+        return std::string(1, (char)('a' + (mode == "random" ? rng() % 26 : (unsigned long long)i % 26)));
+    case Type::String: {
+        std::string s(8, 'a');
+        for (auto& c : s) c = (char)('a' + rng() % 26);
+        return s;
+    }
+    case Type::Vector:
+        break;
+    }
+    return nullptr;
+}
+
+// Vector de `n` elementos (una matriz se reparte en ~sqrt(n) x sqrt(n))
+inline nlohmann::json gen_vector(const harness_gen::Type& t, long long n, std::mt19937& rng,
+    const std::string& mode) {
+    nlohmann::json arr = nlohmann::json::array();
+    const harness_gen::Type& e = *t.elem;
+    if (e.kind == harness_gen::Type::Vector) {
+        long long side = std::max(1LL, (long long)std::llround(std::sqrt((double)n)));
+        for (long long r = 0; r < side; ++r) arr.push_back(gen_vector(e, side, rng, mode));
+        return arr;
+    }
+    if (e.kind == harness_gen::Type::String) {
+        for (long long i = 0; i < n / 8 + 1; ++i) arr.push_back(gen_scalar(e, i, rng, mode));
+        return arr;
+    }
+    for (long long i = 0; i < n; ++i) arr.push_back(gen_scalar(e, i, rng, mode));
+    if (mode == "reversed" && e.kind != harness_gen::Type::Int && e.kind != harness_gen::Type::Long) {
+        std::reverse(arr.begin(), arr.end());
+    }
+    return arr;
+}
+
+// Un caso de tamaño `n` ya codificado para el driver
+inline std::string generate_case(const harness_gen::Signature& sig, const Spec& spec, int n,
+    std::mt19937& rng) {
+    using harness_gen::Type;
+    nlohmann::json in = nlohmann::json::object();
+    for (const auto& p : sig.params) {
+        const nlohmann::json mode = spec.params.contains(p.name) ? spec.params[p.name] : nlohmann::json();
+        const std::string m = mode.is_string() ? mode.get<std::string>() : "";
+        const Type& t = p.type;
+
+        if (!mode.is_null() && !mode.is_string()) {
+            in[p.name] = mode;   // valor fijo tal cual
+        }
+        else if (t.kind == Type::Vector) {
+            in[p.name] = gen_vector(t, n, rng, m.empty() ? "sorted" : m);
+        }
+        else if (t.kind == Type::String) {
+            std::string s((size_t)n, 'a');
+            if (m != "constant") for (auto& c : s) c = (char)('a' + rng() % 26);
+            in[p.name] = std::move(s);
+        }
+        else if (t.kind == Type::Int || t.kind == Type::Long) {
+            if (m == "n") in[p.name] = n;
+            else if (m == "random") in[p.name] = (long long)(rng() % (unsigned)std::max(1, 2 * n));
+            else in[p.name] = -1;   // "absent"
+        }
+        else {
+            in[p.name] = gen_scalar(t, 0, rng, m);
+        }
+    }
+    return harness_gen::encode_case(sig, in);
+}
+
+// ---------------- Ajuste de la curva ----------------
+
+struct Point {
+    int n = 0;
+    int64_t ns = 0;     // mejor tiempo de una llamada
+    int reps = 0;
+};
+
+struct Model {
+    const char* name;
+    double (*f)(double);
+};
+
+// De menor a mayor crecimiento; el orden sirve también para comparar clases
+inline const std::vector<Model>& models() {
+    static const std::vector<Model> M = {
+        { "O(1)",       [](double) { return 1.0; } },
+        { "O(log n)",   [](double n) { return std::log2(n); } },
+        { "O(n)",       [](double n) { return n; } },
+        { "O(n log n)", [](double n) { return n * std::log2(n); } },
+        { "O(n^2)",     [](double n) { return n * n; } },
+        { "O(n^3)",     [](double n) { return n * n * n; } },
+    };
+    return M;
+}
+
+inline int model_rank(const std::string& name) {
+    const auto& M = models();
+    for (size_t i = 0; i < M.size(); ++i) {
+        if (name == M[i].name) return (int)i;
+    }
+    return -1;
+}
+
+struct Fit {
+    std::string best;             // "" si no hay puntos suficientes
+    nlohmann::json errors = nlohmann::json::object();   // modelo -> error relativo
+};
+
+// Un modelo más complejo solo gana a uno más simple si reduce el error al
+// menos en esta fracción (y por encima del ruido): con pocos puntos y tiempos
+// ruidosos, un modelo con más curvatura siempre ajusta algo mejor.
+constexpr double MIN_GAIN = 0.25;
+constexpr double NOISE = 0.02;
+
+// Para cada modelo ajusta t ≈ a + c·f(n) por mínimos cuadrados sobre el error
+// relativo (pesos 1/t²), así un tamaño grande no domina solo por tener tiempos
+// mayores; `a` absorbe el coste fijo de cada llamada. El error de un modelo es
+// la mediana del residuo relativo, para que un solo tamaño desplazado (los
+// datos dejan de caber en caché) no decida la clase. Gana el de menor error
+// salvo que uno más simple quede a menos de MIN_GAIN de él.
+inline Fit fit(const std::vector<Point>& pts) {
+    Fit out;
+    if (pts.size() < 3) return out;
+    const auto& M = models();
+    std::vector<double> err(M.size(), std::numeric_limits<double>::infinity());
+    for (size_t k = 0; k < M.size(); ++k) {
+        // f se normaliza por su máximo para que las sumas no pierdan precisión
+        double fmax = 0;
+        for (const auto& p : pts) fmax = std::max(fmax, M[k].f((double)p.n));
+        if (!(fmax > 0)) continue;
+        double S = 0, Sf = 0, Sff = 0, St = 0, Sft = 0;
+        for (const auto& p : pts) {
+            const double t = std::max<double>(1.0, (double)p.ns);
+            const double w = 1.0 / (t * t);
+            const double f = M[k].f((double)p.n) / fmax;
+            S += w; Sf += w * f; Sff += w * f * f; St += w * t; Sft += w * f * t;
+        }
+        // O(1) (f constante) deja el sistema singular: solo hay término fijo
+        double a = St / S, c = 0;
+        const double det = S * Sff - Sf * Sf;
+        if (det > 1e-12 * S * Sff) {
+            c = (S * Sft - Sf * St) / det;
+            a = (St - c * Sf) / S;
+            // Ni coste fijo ni pendiente negativos: se ajusta sin el término que sobra
+            if (c < 0) { c = 0; a = St / S; }
+            else if (a < 0) { a = 0; c = Sft / Sff; }
+        }
+        std::vector<double> rel;
+        for (const auto& p : pts) {
+            const double t = std::max<double>(1.0, (double)p.ns);
+            rel.push_back(std::fabs(t - a - c * M[k].f((double)p.n) / fmax) / t);
+        }
+        std::sort(rel.begin(), rel.end());
+        const size_t m = rel.size() / 2;
+        err[k] = rel.size() % 2 ? rel[m] : (rel[m - 1] + rel[m]) / 2;
+        out.errors[M[k].name] = std::round(err[k] * 1000.0) / 1000.0;
+    }
+
+    size_t best = 0;
+    for (size_t k = 1; k < M.size(); ++k) {
+        if (err[k] < err[best]) best = k;
+    }
+    for (size_t k = 0; k < best; ++k) {
+        if (err[best] > err[k] * (1.0 - MIN_GAIN) - NOISE) { best = k; break; }
+    }
+    out.best = M[best].name;
+    return out;
+}
+
+} // namespace scaling
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "json.hpp"
+#include "worker_pool.hpp"
+
+// ========================= SUBMISSIONS =========================
+struct Submission {
+    std::string id;
+    std::string status;      // queued -> compiling -> running -> done
+    nlohmann::json results = nlohmann::json::array();
+    int timeMs = 0;          // CPU (usuario + sistema) medido con rusage
+    int memoryKB = 0;        // pico de RSS
+    int wallMs = 0;          // pared de la fase de ejecución
+    int userMs = 0;
+    int sysMs = 0;
+    int queueMs = 0;         // espera en la cola del pool
+    int compileMs = 0;       // pared de la compilación (o de la consulta a la caché)
+    bool cached = false;     // binario o error servido desde la caché
+    std::string profile;     // perfil de compilación: fast | perf
+    std::string verdict;     // AC, WA, CE, RE, TLE, MLE, OLE
+    std::string errorMsg;
+    uint64_t ticket = WorkerPool::NO_TICKET;
+    int casesDone = 0;       // progreso mientras status == "running"
+    int casesTotal = 0;
+    uint64_t version = 0;    // se incrementa en cada cambio (eventos / long-poll)
+
+    // Lo necesario para relanzar un envío en curso tras un reinicio
+    std::string problemId;
+    std::string source;
+    bool stopOnFirstFailure = false;
+    bool measureComplexity = false;
+
+    nlohmann::json complexity;  // medición empírica (null si no se pidió o no hubo AC)
+    nlohmann::json efficiency;  // contadores hardware sumados (o CPU de rusage si no hay)
+    nlohmann::json heap;        // reservas de la solución: suma de casos y mayor pico
+
+    int64_t finishedAtMs = 0;   // epoch ms en que pasó a "done" (para el TTL)
+
+    // Respuesta final ya serializada: un envío terminado no cambia, así que
+    // cada consulta posterior la envía tal cual en vez de volver a armarla
+    std::shared_ptr<const std::string> view;
+};
+
+inline nlohmann::json submission_to_json(const Submission& s) {
+    return {
+        {"id", s.id}, {"status", s.status}, {"results", s.results},
+        {"timeMs", s.timeMs}, {"memoryKB", s.memoryKB}, {"wallMs", s.wallMs},
+        {"userMs", s.userMs}, {"sysMs", s.sysMs}, {"queueMs", s.queueMs},
+        {"compileMs", s.compileMs}, {"cached", s.cached}, {"profile", s.profile}, {"verdict", s.verdict},
+        {"errorMsg", s.errorMsg}, {"problemId", s.problemId},
+        {"stopOnFirstFailure", s.stopOnFirstFailure}, {"measureComplexity", s.measureComplexity},
+        {"complexity", s.complexity}, {"efficiency", s.efficiency}, {"heap", s.heap}, {"finishedAtMs", s.finishedAtMs},
+        {"version", s.version}
+    };
+}
+
+inline void submission_merge_json(Submission& s, const nlohmann::json& j) {
+    s.id = j.value("id", s.id);
+    s.status = j.value("status", s.status);
+    if (j.contains("results")) s.results = j["results"];
+    s.timeMs = j.value("timeMs", s.timeMs);
+    s.memoryKB = j.value("memoryKB", s.memoryKB);
+    s.wallMs = j.value("wallMs", s.wallMs);
+    s.userMs = j.value("userMs", s.userMs);
+    s.sysMs = j.value("sysMs", s.sysMs);
+    s.queueMs = j.value("queueMs", s.queueMs);
+    s.compileMs = j.value("compileMs", s.compileMs);
+    s.cached = j.value("cached", s.cached);
+    s.profile = j.value("profile", s.profile);
+    s.verdict = j.value("verdict", s.verdict);
+    s.errorMsg = j.value("errorMsg", s.errorMsg);
+    s.problemId = j.value("problemId", s.problemId);
+    s.source = j.value("source", s.source);
+    s.stopOnFirstFailure = j.value("stopOnFirstFailure", s.stopOnFirstFailure);
+    s.measureComplexity = j.value("measureComplexity", s.measureComplexity);
+    if (j.contains("complexity")) s.complexity = j["complexity"];
+    if (j.contains("efficiency")) s.efficiency = j["efficiency"];
+    if (j.contains("heap")) s.heap = j["heap"];
+    s.finishedAtMs = j.value("finishedAtMs", s.finishedAtMs);
+}
+
+// ======================= SUBMISSION STORE ======================
+// Almacén en memoria repartido en shards con lock de lectura/escritura
+// propio, para que los GET de la UI no compitan con las actualizaciones
+// del pipeline. Un hilo de limpieza expulsa resultados terminados por TTL
+// y por número máximo de entradas. Opcionalmente cada cambio se añade a un
+// log (JSON por línea) que se reproduce al arrancar.
+class SubmissionStore {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    struct Config {
+        std::chrono::seconds ttl{ 3600 };   // vida de un resultado terminado
+        size_t maxEntries = 10000;
+        std::filesystem::path logPath;      // vacío = sin persistencia
+        // Serializa la respuesta de un envío terminado (Submission::view)
+        std::function<std::string(const Submission&)> finalView;
+    };
+
+    ~SubmissionStore() { stop(); }
+
+    // Reproduce el log (si hay) y arranca el hilo de limpieza
+    void start(const Config& cfg) {
+        cfg_ = cfg;
+        if (!cfg_.logPath.empty()) {
+            replay();
+            compact();
+        }
+        for (auto& sh : shards_) {
+            std::unique_lock<std::shared_mutex> lk(sh.m);
+            for (auto& kv : sh.map) {
+                if (kv.second.status == "done") set_view(kv.second);
+            }
+        }
+        sweeper_ = std::thread([this] { sweep_loop(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lk(sweepM_);
+            if (stopping_) return;
+            stopping_ = true;
+        }
+        sweepCv_.notify_all();
+        if (sweeper_.joinable()) sweeper_.join();
+    }
+
+    void put(const Submission& s) {
+        {
+            auto& sh = shard(s.id);
+            std::unique_lock<std::shared_mutex> lk(sh.m);
+            auto& slot = sh.map[s.id];
+            slot = s;
+            slot.version = 1;
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+        auto rec = submission_to_json(s);
+        rec["source"] = s.source;
+        rec["version"] = 1;
+        append(rec);
+    }
+
+    // Aplica `f` a la submission bajo el lock de escritura de su shard y
+    // despierta a quien espere cambios. Con persist=false no se escribe en el
+    // log (progreso transitorio). Devuelve false si no existe.
+    // El registro se escribe fuera del lock, así que dos cambios seguidos
+    // pueden llegar al log desordenados: cada uno lleva su `version` y
+    // replay() se queda con la más alta.
+    bool update(const std::string& id, const std::function<void(Submission&)>& f,
+        bool persist = true) {
+        nlohmann::json rec;
+        auto& sh = shard(id);
+        {
+            std::unique_lock<std::shared_mutex> lk(sh.m);
+            auto it = sh.map.find(id);
+            if (it == sh.map.end()) return false;
+            f(it->second);
+            ++it->second.version;
+            if (it->second.status == "done" && it->second.finishedAtMs == 0) {
+                it->second.finishedAtMs = now_ms();
+                std::string().swap(it->second.source);   // ya no hace falta retenerlo
+            }
+            if (it->second.status == "done") set_view(it->second);
+            persist = persist && logging();
+            if (persist) rec = submission_to_json(it->second);
+        }
+        sh.changed.notify_all();
+        if (persist) append(rec);
+        return true;
+    }
+
+    // Lee la submission bajo el lock compartido de su shard (sin copiarla)
+    bool read(const std::string& id, const std::function<void(const Submission&)>& f) const {
+        const auto& sh = shard(id);
+        std::shared_lock<std::shared_mutex> lk(sh.m);
+        auto it = sh.map.find(id);
+        if (it == sh.map.end()) return false;
+        f(it->second);
+        return true;
+    }
+
+    // Como read(), pero antes espera hasta `timeout` a que la versión supere
+    // `since`. Si vence el plazo se lee el estado actual igualmente.
+    bool wait_read(const std::string& id, uint64_t since, std::chrono::milliseconds timeout,
+        const std::function<void(const Submission&)>& f) const {
+        const auto& sh = shard(id);
+        std::shared_lock<std::shared_mutex> lk(sh.m);
+        sh.changed.wait_for(lk, timeout, [&] {
+            auto it = sh.map.find(id);
+            return it == sh.map.end() || it->second.version > since;
+        });
+        auto it = sh.map.find(id);
+        if (it == sh.map.end()) return false;
+        f(it->second);
+        return true;
+    }
+
+    bool erase(const std::string& id) {
+        auto& sh = shard(id);
+        {
+            std::unique_lock<std::shared_mutex> lk(sh.m);
+            if (sh.map.erase(id) == 0) return false;
+        }
+        sh.changed.notify_all();
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        append({ {"id", id}, {"deleted", true} });
+        return true;
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    // Envíos que quedaron en cola o ejecutándose (p. ej. al reproducir el log)
+    std::vector<Submission> in_flight() const {
+        std::vector<Submission> out;
+        for (const auto& sh : shards_) {
+            std::shared_lock<std::shared_mutex> lk(sh.m);
+            for (const auto& [id, s] : sh.map) {
+                if (s.status != "done") out.push_back(s);
+            }
+        }
+        return out;
+    }
+
+    // Expulsa resultados vencidos y, si sobran entradas, los terminados más antiguos
+    void sweep() {
+        const int64_t now = now_ms();
+        const int64_t ttlMs = (int64_t)cfg_.ttl.count() * 1000;
+        std::vector<std::pair<int64_t, std::string>> finished;
+        std::vector<std::string> expired;
+
+        for (auto& sh : shards_) {
+            std::shared_lock<std::shared_mutex> lk(sh.m);
+            for (const auto& [id, s] : sh.map) {
+                if (s.status != "done") continue;
+                if (ttlMs > 0 && now - s.finishedAtMs >= ttlMs) expired.push_back(id);
+                else finished.emplace_back(s.finishedAtMs, id);
+            }
+        }
+        for (const auto& id : expired) erase(id);
+
+        if (size() > cfg_.maxEntries && !finished.empty()) {
+            size_t excess = std::min(size() - cfg_.maxEntries, finished.size());
+            std::partial_sort(finished.begin(), finished.begin() + excess, finished.end());
+            for (size_t i = 0; i < excess; ++i) erase(finished[i].second);
+        }
+
+        // El log crece con cada cambio: se reescribe cuando duplica lo vivo
+        if (logging() && logRecords_.load() > 2 * size() + 1024) compact();
+    }
+
+private:
+    // Una variable de condición por shard: los que esperan una submission
+    // solo se despiertan por cambios en su mismo shard.
+    struct Shard {
+        mutable std::shared_mutex m;
+        mutable std::condition_variable_any changed;
+        std::unordered_map<std::string, Submission> map;
+    };
+
+    static int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void set_view(Submission& s) const {
+        if (cfg_.finalView) s.view = std::make_shared<const std::string>(cfg_.finalView(s));
+    }
+
+    Shard& shard(const std::string& id) { return shards_[std::hash<std::string>{}(id) % SHARDS]; }
+    const Shard& shard(const std::string& id) const {
+        return shards_[std::hash<std::string>{}(id) % SHARDS];
+    }
+
+    bool logging() const { return !cfg_.logPath.empty(); }
+
+    void append(const nlohmann::json& rec) {
+        if (!logging()) return;
+        std::string line = rec.dump() + "\n";
+        std::lock_guard<std::mutex> lk(logM_);
+        if (!log_) {
+            log_ = std::fopen(cfg_.logPath.string().c_str(), "ab");
+            if (!log_) return;
+        }
+        std::fwrite(line.data(), 1, line.size(), log_);
+        std::fflush(log_);
+        logRecords_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void replay() {
+        std::ifstream f(cfg_.logPath, std::ios::binary);
+        std::string line;
+        std::unordered_map<std::string, Submission> all;
+        std::unordered_map<std::string, uint64_t> latest;   // versión más alta vista por id
+        // Ids borrados: un update que llegó al log tras el borrado no los revive
+        std::unordered_set<std::string> deleted;
+        while (std::getline(f, line)) {
+            auto rec = nlohmann::json::parse(line, nullptr, false);
+            if (rec.is_discarded() || !rec.is_object()) continue;   // línea truncada
+            std::string id = rec.value("id", "");
+            if (id.empty()) continue;
+            if (rec.value("deleted", false)) {
+                all.erase(id);
+                latest.erase(id);
+                deleted.insert(id);
+                continue;
+            }
+            // Registros sin versión (logs anteriores) se aplican en orden
+            const uint64_t v = rec.value("version", (uint64_t)0);
+            if (deleted.count(id)) {
+                if (v != 1) continue;   // solo un put() (versión 1) vuelve a crearlo
+                deleted.erase(id);
+            }
+            uint64_t& last = latest[id];
+            if (v != 0 && v < last) continue;
+            if (v != 0) last = v;
+            submission_merge_json(all[id], rec);
+        }
+        for (auto& [id, s] : all) {
+            auto& sh = shard(id);
+            std::unique_lock<std::shared_mutex> lk(sh.m);
+            // Se sigue numerando desde la última versión para que el orden valga tras reiniciar
+            s.version = std::max<uint64_t>(latest[id], 1);
+            sh.map[id] = std::move(s);
+            size_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Reescribe el log con una sola línea por submission viva
+    void compact() {
+        std::lock_guard<std::mutex> lk(logM_);
+        auto tmp = cfg_.logPath;
+        tmp += ".tmp";
+        std::FILE* out = std::fopen(tmp.string().c_str(), "wb");
+        if (!out) return;
+        uint64_t n = 0;
+        for (const auto& sh : shards_) {
+            std::shared_lock<std::shared_mutex> slk(sh.m);
+            for (const auto& [id, s] : sh.map) {
+                auto rec = submission_to_json(s);
+                if (s.status != "done") rec["source"] = s.source;
+                std::string line = rec.dump() + "\n";
+                std::fwrite(line.data(), 1, line.size(), out);
+                ++n;
+            }
+        }
+        std::fclose(out);
+        if (log_) {
+            std::fclose(log_);
+            log_ = nullptr;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, cfg_.logPath, ec);
+        logRecords_.store(n);
+    }
+
+    void sweep_loop() {
+        std::unique_lock<std::mutex> lk(sweepM_);
+        while (!stopping_) {
+            sweepCv_.wait_for(lk, std::chrono::seconds(10));
+            if (stopping_) break;
+            lk.unlock();
+            sweep();
+            lk.lock();
+        }
+    }
+
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<size_t> size_{ 0 };
+    Config cfg_;
+
+    std::mutex logM_;
+    std::FILE* log_ = nullptr;
+    std::atomic<uint64_t> logRecords_{ 0 };
+
+    std::thread sweeper_;
+    std::mutex sweepM_;
+    std::condition_variable sweepCv_;
+    bool stopping_ = false;
+};
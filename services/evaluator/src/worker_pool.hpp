@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ======================= WORKER POOL ===========================
+// Pool de hilos de tamaño fijo con cola FIFO acotada. Cada trabajo recibe un
+// "ticket" creciente; como la cola nunca reordena ni cancela, la posición de
+// un trabajo es simplemente ticket - (trabajos ya tomados por un worker).
+class WorkerPool {
+public:
+    static constexpr uint64_t NO_TICKET = UINT64_MAX;
+
+    WorkerPool(size_t workers, size_t maxQueue)
+        : maxQueue_(maxQueue) {
+        if (workers == 0) workers = 1;
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this] { loop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Encola un trabajo. Devuelve su ticket, o NO_TICKET si la cola está llena.
+    uint64_t submit(std::function<void()> job) {
+        uint64_t ticket;
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (stop_ || queue_.size() >= maxQueue_) return NO_TICKET;
+            ticket = nextTicket_++;
+            queue_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+        return ticket;
+    }
+
+    // Posición (1 = el siguiente en salir) o 0 si ya lo tomó un worker.
+    uint64_t position(uint64_t ticket) const {
+        if (ticket == NO_TICKET) return 0;
+        uint64_t taken = taken_.load(std::memory_order_acquire);
+        return ticket >= taken ? ticket - taken + 1 : 0;
+    }
+
+    size_t queued() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return queue_.size();
+    }
+
+    size_t active() const { return active_.load(std::memory_order_relaxed); }
+    size_t workers() const { return threads_.size(); }
+    size_t capacity() const { return maxQueue_; }
+
+private:
+    void loop() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                cv_.wait(lk, [this] { return stop_ || !queue_.empty(); });
+                if (stop_ && queue_.empty()) return;
+                job = std::move(queue_.front());
+                queue_.pop_front();
+                taken_.fetch_add(1, std::memory_order_release);
+                active_.fetch_add(1, std::memory_order_relaxed);
+            }
+            try {
+                job();
+            }
+            catch (...) {
+                // Un trabajo que lanza no debe tumbar al worker
+            }
+            active_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    const size_t maxQueue_;
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    std::vector<std::thread> threads_;
+    uint64_t nextTicket_ = 0;
+    std::atomic<uint64_t> taken_{ 0 };
+    std::atomic<size_t> active_{ 0 };
+    bool stop_ = false;
+};
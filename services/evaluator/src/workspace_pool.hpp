@@ -0,0 +1,337 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+
+// ======================= WORKSPACE POOL ========================
+// Directorios de trabajo reciclados para el pipeline. Se crean al arrancar,
+// por defecto en /dev/shm (en RAM) si allí se pueden ejecutar binarios, y
+// cada envío toma uno en exclusiva con lease(). Al soltarlo se vacía y
+// vuelve al pool: ningún envío crea directorios ni deja restos en disco.
+// `quotaBytes` acota lo que puede ocupar un workspace: el pipeline da ese
+// RLIMIT_FSIZE al compilador y consulta over_quota() mientras corre cada
+// caso, matando al programa en cuanto se pasa.
+// Un hilo recolector borra cada `reapInterval` los cc_eval_* abandonados
+// (directorios de versiones que no los borraban y pools de procesos que ya
+// no existen) y reintenta los workspaces que no se pudieron vaciar.
+class WorkspacePool {
+public:
+    struct Config {
+        std::filesystem::path base;                 // vacío = /dev/shm si sirve, si no el temporal
+        size_t size = 4;
+        uint64_t quotaBytes = 64ull * 1024 * 1024;  // por workspace
+        std::chrono::seconds reapInterval{ 60 };
+        std::chrono::seconds reapAge{ 600 };        // antigüedad mínima de un cc_eval_* huérfano
+    };
+
+    struct Stats {
+        std::string root;
+        bool ramBacked = false;
+        size_t size = 0;
+        size_t inUse = 0;
+        size_t retired = 0;             // no se pudieron vaciar; el recolector los reintenta
+        uint64_t leases = 0;
+        uint64_t waits = 0;             // leases que esperaron a un workspace libre
+        uint64_t overQuota = 0;         // devueltos ocupando más que la cuota
+        uint64_t scrubFailures = 0;
+        uint64_t reaped = 0;            // directorios huérfanos borrados
+    };
+
+    // Workspace prestado; vuelve al pool (vaciado) al destruirse o en release()
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& o) noexcept : pool_(o.pool_), index_(o.index_), path_(std::move(o.path_)) {
+            o.pool_ = nullptr;
+        }
+        Lease& operator=(Lease&& o) noexcept {
+            if (this != &o) {
+                release();
+                pool_ = o.pool_;
+                index_ = o.index_;
+                path_ = std::move(o.path_);
+                o.pool_ = nullptr;
+            }
+            return *this;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        const std::filesystem::path& path() const { return path_; }
+
+        bool over_quota() const {
+            return pool_ && usage(path_) > pool_->cfg_.quotaBytes;
+        }
+
+        void release() {
+            if (!pool_) return;
+            pool_->give_back(index_);
+            pool_ = nullptr;
+        }
+
+    private:
+        friend class WorkspacePool;
+        Lease(WorkspacePool* pool, size_t index, std::filesystem::path path)
+            : pool_(pool), index_(index), path_(std::move(path)) {}
+
+        WorkspacePool* pool_ = nullptr;
+        size_t index_ = 0;
+        std::filesystem::path path_;
+    };
+
+    ~WorkspacePool() { stop(); }
+
+    // Devuelve false si no se pudo crear el directorio raíz
+    bool start(const Config& cfg) {
+        namespace fs = std::filesystem;
+        cfg_ = cfg;
+        if (cfg_.size == 0) cfg_.size = 1;
+
+        fs::path base = cfg_.base;
+        if (base.empty()) base = executable_dir("/dev/shm") ? fs::path("/dev/shm") : fs::temp_directory_path();
+        base_ = base;
+        ramBacked_ = is_tmpfs(base_);
+        root_ = base_ / ("cc_eval_ws." + std::to_string(pid()));
+
+        std::error_code ec;
+        fs::remove_all(root_, ec);
+        fs::create_directories(root_, ec);
+        if (ec) return false;
+
+        for (size_t i = 0; i < cfg_.size; ++i) {
+            fs::create_directories(dir(i), ec);
+            if (ec) retired_.push_back(i);
+            else free_.push_back(i);
+        }
+
+        reaper_ = std::thread([this] { reap_loop(); });
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (stopping_) return;
+            stopping_ = true;
+        }
+        reapCv_.notify_all();
+        if (reaper_.joinable()) reaper_.join();
+        if (!root_.empty()) {
+            std::error_code ec;
+            std::filesystem::remove_all(root_, ec);
+        }
+    }
+
+    // Espera a que haya un workspace libre (con tantos como workers no espera nunca)
+    Lease lease() {
+        std::unique_lock<std::mutex> lk(m_);
+        if (free_.empty()) ++waits_;
+        freeCv_.wait(lk, [&] { return !free_.empty(); });
+        size_t i = free_.back();
+        free_.pop_back();
+        ++leases_;
+        return Lease(this, i, dir(i));
+    }
+
+    const Config& config() const { return cfg_; }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        Stats s;
+        s.root = root_.string();
+        s.ramBacked = ramBacked_;
+        s.size = cfg_.size;
+        s.retired = retired_.size();
+        s.inUse = cfg_.size - free_.size() - retired_.size();
+        s.leases = leases_;
+        s.waits = waits_;
+        s.overQuota = overQuota_;
+        s.scrubFailures = scrubFailures_;
+        s.reaped = reaped_;
+        return s;
+    }
+
+    // Bytes ocupados bajo `dir`. Como en tmpfs, cada entrada cuenta al menos
+    // una página: miles de ficheros diminutos también agotan la cuota.
+    static uint64_t usage(const std::filesystem::path& dir) {
+        namespace fs = std::filesystem;
+        constexpr uint64_t page = 4096;
+        uint64_t total = 0;
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code fec;
+            uint64_t n = it->is_regular_file(fec) ? it->file_size(fec) : 0;
+            if (fec) n = 0;
+            total += (n + page - 1) / page * page + (n == 0 ? page : 0);
+        }
+        return total;
+    }
+
+private:
+    std::filesystem::path dir(size_t i) const {
+        return root_ / ("ws_" + std::to_string(i));
+    }
+
+    // Vacía el workspace; si algo se resiste lo borra entero y lo vuelve a crear
+    static bool scrub(const std::filesystem::path& d) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        for (fs::directory_iterator it(d, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code rec;
+            fs::remove_all(it->path(), rec);
+        }
+        if (!ec && fs::is_empty(d, ec) && !ec) return true;
+        ec.clear();
+        fs::remove_all(d, ec);
+        fs::create_directories(d, ec);
+        return !ec && fs::is_empty(d, ec) && !ec;
+    }
+
+    void give_back(size_t i) {
+        const auto d = dir(i);
+        const bool over = usage(d) > cfg_.quotaBytes;
+        const bool ok = scrub(d);
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (over) ++overQuota_;
+            if (ok) free_.push_back(i);
+            else {
+                ++scrubFailures_;
+                retired_.push_back(i);
+            }
+        }
+        if (ok) freeCv_.notify_one();
+    }
+
+    void reap_loop() {
+        // Primera pasada nada más arrancar: recoge lo que dejó un proceso anterior
+        std::unique_lock<std::mutex> lk(m_);
+        while (!stopping_) {
+            std::vector<size_t> retry;
+            retry.swap(retired_);
+            lk.unlock();
+
+            std::vector<size_t> revived, still;
+            for (size_t i : retry) (scrub(dir(i)) ? revived : still).push_back(i);
+            uint64_t reaped = reap(base_);
+            if (std::filesystem::temp_directory_path() != base_) {
+                reaped += reap(std::filesystem::temp_directory_path());
+            }
+
+            lk.lock();
+            reaped_ += reaped;
+            free_.insert(free_.end(), revived.begin(), revived.end());
+            retired_.insert(retired_.end(), still.begin(), still.end());
+            if (!revived.empty()) freeCv_.notify_all();
+            reapCv_.wait_for(lk, cfg_.reapInterval, [&] { return stopping_; });
+        }
+    }
+
+    // Borra en `where` los pools de procesos muertos y los cc_eval_xxxxxx viejos
+    uint64_t reap(const std::filesystem::path& where) const {
+        namespace fs = std::filesystem;
+        const auto cutoff = fs::file_time_type::clock::now() - cfg_.reapAge;
+        uint64_t n = 0;
+        std::error_code ec;
+        for (fs::directory_iterator it(where, ec), end; !ec && it != end; it.increment(ec)) {
+            const std::string name = it->path().filename().string();
+            std::error_code fec;
+            if (name.compare(0, 8, "cc_eval_") != 0 || !it->is_directory(fec)) continue;
+
+            bool orphan = false;
+            if (name.compare(0, 11, "cc_eval_ws.") == 0) {
+                const long owner = std::strtol(name.c_str() + 11, nullptr, 10);
+                orphan = owner > 0 && owner != pid() && !alive(owner);
+            }
+            else if (legacy_name(name)) {
+                auto t = it->last_write_time(fec);
+                orphan = !fec && t < cutoff;
+            }
+            if (!orphan) continue;
+            fs::remove_all(it->path(), fec);
+            if (!fec) ++n;
+        }
+        return n;
+    }
+
+    // Los directorios por envío de antes: "cc_eval_" + 6 caracteres [a-z0-9]
+    static bool legacy_name(const std::string& name) {
+        if (name.size() != 14) return false;
+        for (size_t i = 8; i < name.size(); ++i) {
+            char c = name[i];
+            if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))) return false;
+        }
+        return true;
+    }
+
+    static long pid() {
+#ifdef _WIN32
+        return (long)_getpid();
+#else
+        return (long)getpid();
+#endif
+    }
+
+    static bool alive(long p) {
+#ifdef _WIN32
+        (void)p;
+        return true;
+#else
+        return kill((pid_t)p, 0) == 0 || errno != ESRCH;
+#endif
+    }
+
+    // Se puede escribir y ejecutar allí (un /dev/shm montado noexec no sirve)
+    static bool executable_dir(const char* p) {
+#ifdef _WIN32
+        (void)p;
+        return false;
+#else
+        struct statvfs sv;
+        if (access(p, W_OK | X_OK) != 0 || statvfs(p, &sv) != 0) return false;
+        return (sv.f_flag & ST_NOEXEC) == 0;
+#endif
+    }
+
+    static bool is_tmpfs(const std::filesystem::path& p) {
+#ifdef __linux__
+        struct statfs sf;
+        return statfs(p.c_str(), &sf) == 0 && sf.f_type == 0x01021994;   // TMPFS_MAGIC
+#else
+        (void)p;
+        return false;
+#endif
+    }
+
+    Config cfg_;
+    std::filesystem::path base_, root_;
+    bool ramBacked_ = false;
+
+    mutable std::mutex m_;
+    std::condition_variable freeCv_, reapCv_;
+    std::vector<size_t> free_, retired_;
+    uint64_t leases_ = 0, waits_ = 0, overQuota_ = 0, scrubFailures_ = 0, reaped_ = 0;
+    bool stopping_ = false;
+    std::thread reaper_;
+};
@@ -1,4 +1,4 @@
-from flask import Flask, request, jsonify
+from flask import Flask, request, jsonify, Response, stream_with_context
 from openai import OpenAI, OpenAIError
 from dotenv import load_dotenv
 import os
@@ -26,17 +26,24 @@ INSTRUCTION = (
     "No uses negritas ni otro markdown, solo texto plano."
 )
 
-@app.post("/llm-feedback")
-def llm_feedback():
-    data = request.get_json(force=True)
-    prompt = data.get("prompt", "")
-    problem_id = data.get("problemId", "unknown")
+MODEL = "x-ai/grok-4.1-fast:free"  # 👈 Modelo free de xAI (Grok) que viste en la lista
 
-    if not prompt:
-        return jsonify({"error": "prompt vacío"}), 400
+RATE_LIMIT_MSG = (
+    "La IA está temporalmente saturada (límite de uso alcanzado en el modelo gratuito). "
+    "Tu solución es válida y el sistema funciona, "
+    "pero en este momento el modelo no puede responder. "
+    "Intenta ejecutar de nuevo en unos segundos."
+)
+
+
+# Inicio de línea que avisa al Analyzer de que el stream se cortó: el resto
+# de la línea es el motivo y esa respuesta no se guarda en su caché
+STREAM_ERROR = "\x1e"
 
+
+def build_full_prompt(prompt, problem_id):
     # Construimos TODO como un único mensaje de usuario
-    full_prompt = (
+    return (
         INSTRUCTION
         + "\n\nID del problema: "
         + problem_id
@@ -46,10 +53,26 @@ def llm_feedback():
           "solo pistas, posibles errores y mejoras."
     )
 
+
+def is_rate_limit(e):
+    msg = str(e)
+    return "429" in msg or "rate" in msg.lower()
+
+
+@app.post("/llm-feedback")
+def llm_feedback():
+    data = request.get_json(force=True)
+    prompt = data.get("prompt", "")
+    problem_id = data.get("problemId", "unknown")
+
+    if not prompt:
+        return jsonify({"error": "prompt vacío"}), 400
+
+    full_prompt = build_full_prompt(prompt, problem_id)
+
     try:
         resp = client.chat.completions.create(
-            # 👇 Modelo free de xAI (Grok) que viste en la lista
-            model="x-ai/grok-4.1-fast:free",
+            model=MODEL,
             messages=[
                 {
                     "role": "user",
@@ -68,15 +91,8 @@ def llm_feedback():
         msg = str(e)
 
         # Rate limit / cuota
-        if "429" in msg or "rate" in msg.lower():
-            return jsonify({
-                "feedback": (
-                    "La IA está temporalmente saturada (límite de uso alcanzado en el modelo gratuito). "
-                    "Tu solución es válida y el sistema funciona, "
-                    "pero en este momento el modelo no puede responder. "
-                    "Intenta ejecutar de nuevo en unos segundos."
-                )
-            }), 200
+        if is_rate_limit(e):
+            return jsonify({"feedback": RATE_LIMIT_MSG}), 200
 
         return jsonify({"error": msg}), 500
 
@@ -85,5 +101,53 @@ def llm_feedback():
         return jsonify({"error": "error inesperado en llm_proxy"}), 500
 
 
+
+# Igual que /llm-feedback pero devuelve el texto en streaming (text/plain)
+# a medida que lo genera el modelo; el Analyzer lo parte en líneas.
+@app.post("/llm-feedback/stream")
+def llm_feedback_stream():
+    data = request.get_json(force=True)
+    prompt = data.get("prompt", "")
+    problem_id = data.get("problemId", "unknown")
+
+    if not prompt:
+        return jsonify({"error": "prompt vacío"}), 400
+
+    try:
+        stream = client.chat.completions.create(
+            model=MODEL,
+            messages=[
+                {
+                    "role": "user",
+                    "content": build_full_prompt(prompt, problem_id),
+                }
+            ],
+            max_tokens=350,
+            temperature=0.3,
+            stream=True,
+        )
+    except OpenAIError as e:
+        print("Error al llamar a OpenRouter:", repr(e))
+        if is_rate_limit(e):
+            # 429 y no 200: es un fallo pasajero, no una respuesta que cachear
+            return jsonify({"error": RATE_LIMIT_MSG}), 429
+        return jsonify({"error": str(e)}), 500
+    except Exception as e:
+        print("Error inesperado en llm_proxy:", repr(e))
+        return jsonify({"error": "error inesperado en llm_proxy"}), 500
+
+    def generate():
+        try:
+            for chunk in stream:
+                if chunk.choices and chunk.choices[0].delta.content:
+                    yield chunk.choices[0].delta.content
+        except Exception as e:
+            # Ya se enviaron cabeceras: se avisa con la marca STREAM_ERROR
+            print("Error durante el streaming:", repr(e))
+            yield "\n" + STREAM_ERROR + "La respuesta de la IA se interrumpió.\n"
+
+    return Response(stream_with_context(generate()), mimetype="text/plain")
+
+
 if __name__ == "__main__":
     app.run(host="0.0.0.0", port=8090)
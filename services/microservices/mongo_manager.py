@@ -13,6 +13,11 @@ problems_collection = db["problems"]
 # =======================
 #  Datos de ejemplo (seed)
 # =======================
+# "signature" describe Solution::<method> con tipos C++ (int, long long, double,
+# bool, char, string, vector<...>). El Evaluator genera el harness a partir de
+# ella y ejecuta los "tests" tal cual; si returns es "void", se imprime el
+# parámetro indicado en "output". "scaling" (opcional) indica cómo generar
+# entradas grandes para medir la complejidad y cuál se espera.
 sample_problems = [
     {
         "id": "two-sum",
@@ -35,6 +40,15 @@ sample_problems = [
             "    }\n"
             "};\n"
         ),
+        "signature": {
+            "method": "twoSum",
+            "returns": "vector<int>",
+            "params": [
+                {"name": "nums", "type": "vector<int>"},
+                {"name": "target", "type": "int"},
+            ],
+        },
+        "scaling": {"expected": "O(n)", "params": {"target": "absent"}},
         "tests": [
             {
                 "in": {"nums": [2, 7, 11, 15], "target": 9},
@@ -66,6 +80,13 @@ sample_problems = [
             "    }\n"
             "};\n"
         ),
+        "signature": {
+            "method": "reverseString",
+            "returns": "void",
+            "output": "s",
+            "params": [{"name": "s", "type": "vector<char>"}],
+        },
+        "scaling": {"expected": "O(n)"},
         "tests": [
             {
                 "in": {"s": ["h", "e", "l", "l", "o"]},
@@ -98,6 +119,15 @@ sample_problems = [
             "    }\n"
             "};\n"
         ),
+        "signature": {
+            "method": "search",
+            "returns": "int",
+            "params": [
+                {"name": "nums", "type": "vector<int>"},
+                {"name": "target", "type": "int"},
+            ],
+        },
+        "scaling": {"expected": "O(log n)", "params": {"target": "absent"}},
         "tests": [
             {
                 "in": {"nums": [-1, 0, 3, 5, 9, 12], "target": 9},
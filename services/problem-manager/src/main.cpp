@@ -1,14 +1,124 @@
 #include "httplib.h"
 #include "json.hpp"
+#include "response_cache.hpp"
+#include "problem_store.hpp"
+#include "upstream_pool.hpp"
+#include "http_metrics.hpp"
+#include "http_trace.hpp"
 #include <iostream>
+#include <cstdlib>
 
 using json = nlohmann::json;
 
 // CORS igual que en analyzer/evaluator
 static void set_cors(httplib::Response& res) {
     res.set_header("Access-Control-Allow-Origin", "*");
-    res.set_header("Access-Control-Allow-Methods", "GET,POST,OPTIONS");
-    res.set_header("Access-Control-Allow-Headers", "Content-Type");
+    res.set_header("Access-Control-Allow-Methods", "GET,POST,DELETE,OPTIONS");
+    res.set_header("Access-Control-Allow-Headers", "Content-Type, If-None-Match, traceparent");
+    res.set_header("Access-Control-Expose-Headers", "ETag, traceresponse");
+}
+
+static size_t env_size(const char* name, size_t def) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return def;
+    char* end = nullptr;
+    unsigned long long n = std::strtoull(v, &end, 10);
+    return (end && *end == '\0') ? (size_t)n : def;
+}
+
+// Backend "native" (por defecto): los problemas viven en STORE y Mongo solo
+// se usa para importar/exportar. Backend "mongo": proxy a mongo_manager.py.
+static bool NATIVE = true;
+static ProblemStore STORE;
+
+// Caché de lecturas del modo proxy: la lista y cada detalle salen de memoria
+// hasta que un POST/DELETE de este servicio los invalida (o vence el TTL,
+// por si alguien escribe directamente en Mongo)
+static ResponseCache CACHE;
+
+// Fallo al hablar con mongo_manager.py: 503 si el breaker o el pool lo
+// cortaron sin intentarlo, 500 si la llamada en sí falló
+static void upstream_error(httplib::Response& res, const httplib::Result& r) {
+    if (r.error() == httplib::Error::Canceled) {
+        res.status = 503;
+        res.set_header("Retry-After", "10");
+        res.set_content(R"({"error":"mongo_manager no disponible, circuito abierto"})", "application/json");
+    }
+    else if (r.error() == httplib::Error::ResourceExhaustion) {
+        res.status = 503;
+        res.set_content(R"({"error":"sin conexiones libres hacia mongo_manager"})", "application/json");
+    }
+    else {
+        res.status = 500;
+        res.set_content(R"({"error":"mongo_manager no responde en :8081"})", "application/json");
+    }
+}
+
+// Responde con un payload precalculado; 304 si el cliente ya tiene ese ETag
+static void send_entry(const httplib::Request& req, httplib::Response& res, const PayloadPtr& p) {
+    if (send_payload(req, res, p)) CACHE.count_not_modified();
+}
+
+// GET con lectura a través de la caché; solo se guardan respuestas 200
+static void cached_get(UpstreamPool& mongo, const std::string& path,
+    const httplib::Request& req, httplib::Response& res) {
+    if (auto hit = CACHE.get(path)) {
+        send_entry(req, res, hit);
+        return;
+    }
+
+    uint64_t version = CACHE.version();
+    trace::Span span("upstream", trace::request_context(req));
+    auto pres = mongo.get(path);
+    span.attr("path", path).attr("http.status", pres ? pres->status : 0).end();
+    if (!pres) {
+        upstream_error(res, pres);
+        return;
+    }
+    if (pres->status != 200) {
+        res.status = pres->status;
+        res.set_content(pres->body, "application/json");
+        return;
+    }
+    send_entry(req, res, CACHE.put(path, pres->status, pres->body, version));
+}
+
+// Trae de Mongo los problemas que no estén ya en STORE
+static json import_from_mongo(UpstreamPool& mongo) {
+    auto lres = mongo.get("/problems");
+    if (!lres || lres->status != 200) {
+        return { {"error", "mongo_manager no responde en :8081"} };
+    }
+    auto list = json::parse(lres->body, nullptr, false);
+    if (!list.is_array()) return { {"error", "respuesta inválida de mongo_manager"} };
+
+    int imported = 0, skipped = 0, failed = 0;
+    for (const auto& s : list) {
+        std::string id = s.is_object() ? s.value("id", "") : "";
+        if (!ProblemStore::valid_id(id) || STORE.get(id)) {
+            ++skipped;
+            continue;
+        }
+        std::string path = "/problems/" + id;
+        auto dres = mongo.get(path);
+        auto doc = dres && dres->status == 200 ? json::parse(dres->body, nullptr, false) : json();
+        if (STORE.create(doc) == ProblemStore::PutResult::Created) ++imported;
+        else ++failed;
+    }
+    return { {"imported", imported}, {"skipped", skipped}, {"failed", failed} };
+}
+
+// Sube a Mongo los problemas de STORE (los que ya existen allí responden 409)
+static json export_to_mongo(UpstreamPool& mongo) {
+    int exported = 0, skipped = 0, failed = 0;
+    for (const auto& doc : STORE.all()) {
+        auto pres = mongo.post("/problems", doc.dump(), "application/json");
+        if (!pres) return { {"error", "mongo_manager no responde en :8081"}, {"exported", exported} };
+        if (pres->status == 201 || pres->status == 200) ++exported;
+        else if (pres->status == 409) ++skipped;
+        else ++failed;
+    }
+    return { {"exported", exported}, {"skipped", skipped}, {"failed", failed} };
 }
 
 int main() {
@@ -20,61 +130,231 @@ int main() {
         res.status = 200;
         });
 
-    // Health check simple
-    svr.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+    // Trazas: ring buffer en memoria (GET /traces) y, opcionalmente, fichero JSONL
+    trace::Tracer::Config traceCfg;
+    traceCfg.service = "problem-manager";
+    if (const char* t = std::getenv("CC_PM_TRACE")) traceCfg.enabled = std::string(t) != "0";
+    traceCfg.capacity = env_size("CC_PM_TRACE_BUFFER", 4096);
+    if (const char* p = std::getenv("CC_PM_TRACE_FILE")) traceCfg.file = p;
+    trace::tracer().start(traceCfg);
+
+    // Pool de conexiones hacia el microservicio Python (mongo_manager.py en 8081)
+    UpstreamPool::Config up;
+    if (const char* h = std::getenv("CC_PM_MONGO_HOST")) up.host = h;
+    up.port = (int)env_size("CC_PM_MONGO_PORT", 8081);
+    up.size = env_size("CC_PM_UPSTREAM_POOL", 8);
+    up.connectTimeoutMs = (int)env_size("CC_PM_UPSTREAM_CONNECT_MS", 1000);
+    up.readTimeoutMs = (int)env_size("CC_PM_UPSTREAM_READ_MS", 5000);
+    up.acquireTimeoutMs = (int)env_size("CC_PM_UPSTREAM_ACQUIRE_MS", 2000);
+    up.failureThreshold = (int)env_size("CC_PM_BREAKER_FAILURES", 5);
+    up.openMs = (int)env_size("CC_PM_BREAKER_OPEN_MS", 10000);
+
+    auto& reg = metrics::registry();
+    auto& upSeconds = reg.histogram("cc_pm_upstream_seconds", "Duración de las llamadas a mongo_manager");
+    auto& upCalls = reg.counter_family("cc_pm_upstream_calls_total",
+        "Llamadas a mongo_manager por resultado", { "result" });
+    up.onCall = [&upSeconds, &upCalls](double seconds, bool ok) {
+        upSeconds.observe(seconds);
+        upCalls.with({ ok ? "ok" : "error" }).inc();
+    };
+    UpstreamPool mongo(up);
+
+    const char* backend = std::getenv("CC_PM_BACKEND");
+    NATIVE = !(backend && std::string(backend) == "mongo");
+    CACHE.set_ttl(std::chrono::seconds(env_size("CC_PM_CACHE_TTL_S", 300)));
+
+    if (NATIVE) {
+        const char* dataDir = std::getenv("CC_PM_DATA_DIR");
+        if (!STORE.open(dataDir && *dataDir ? dataDir : "pm_data")) {
+            std::cerr << "[PM-CPP] Aviso: no se pudo compactar el snapshot de problemas\n";
+        }
+        // Primer arranque: si el almacén está vacío se intenta importar de Mongo
+        if (STORE.size() == 0 && env_size("CC_PM_IMPORT_ON_EMPTY", 1)) {
+            std::cout << "[PM-CPP] Almacén vacío, importando de Mongo: "
+                << import_from_mongo(mongo).dump() << "\n";
+        }
+        std::cout << "[PM-CPP] " << STORE.size() << " problemas en el almacén nativo\n";
+    }
+
+    // Métricas leídas al vuelo del almacén, la caché y el pool
+    reg.gauge_fn("cc_pm_problems", "Problemas en el almacén nativo", [] { return (double)STORE.size(); });
+    reg.counter_fn("cc_pm_cache_hits_total", "Aciertos de la caché del modo proxy",
+        [] { return (double)CACHE.stats().hits; });
+    reg.counter_fn("cc_pm_cache_misses_total", "Fallos de la caché del modo proxy",
+        [] { return (double)CACHE.stats().misses; });
+    reg.counter_fn("cc_pm_not_modified_total", "Respuestas 304 por ETag",
+        [] { return (double)CACHE.stats().notModified; });
+    reg.gauge_fn("cc_pm_upstream_in_use", "Conexiones a mongo_manager en uso",
+        [&mongo] { return (double)mongo.stats().inUse; });
+    reg.gauge_fn("cc_pm_upstream_pool_size", "Tamaño del pool hacia mongo_manager",
+        [&mongo] { return (double)mongo.stats().size; });
+    reg.gauge_fn("cc_pm_upstream_breaker_open", "1 si el circuit breaker no está cerrado",
+        [&mongo] { return mongo.stats().breaker == "closed" ? 0.0 : 1.0; });
+    reg.counter_fn("cc_pm_upstream_rejected_total", "Llamadas cortadas por el breaker",
+        [&mongo] { return (double)mongo.stats().rejected; });
+    reg.counter_fn("cc_pm_upstream_acquire_timeouts_total", "Llamadas sin conexión libre a tiempo",
+        [&mongo] { return (double)mongo.stats().acquireTimeouts; });
+    metrics::register_process_metrics(reg);
+    metrics::instrument(svr, reg, trace::record_request);
+    trace::serve_traces(svr);
+
+    // Health check con el backend, la caché y el pool hacia Mongo
+    svr.Get("/health", [&mongo](const httplib::Request&, httplib::Response& res) {
         set_cors(res);
-        res.set_content(R"({"ok":true,"service":"problem-manager-cpp"})", "application/json");
+        json out = {
+            {"ok", true},
+            {"service", "problem-manager-cpp"},
+            {"backend", NATIVE ? "native" : "mongo"}
+        };
+        if (NATIVE) {
+            out["problems"] = STORE.size();
+        }
+        else {
+            auto cs = CACHE.stats();
+            out["cache"] = {
+                {"hits", cs.hits},
+                {"misses", cs.misses},
+                {"notModified", cs.notModified},
+                {"invalidations", cs.invalidations},
+                {"entries", cs.entries}
+            };
+        }
+        auto us = mongo.stats();
+        uint64_t calls = us.requests - us.rejected - us.acquireTimeouts;
+        out["upstream"] = {
+            {"size", us.size},
+            {"inUse", us.inUse},
+            {"breaker", us.breaker},
+            {"requests", us.requests},
+            {"failures", us.failures},
+            {"rejected", us.rejected},
+            {"acquireTimeouts", us.acquireTimeouts},
+            {"avgWaitUs", calls ? us.waitUsTotal / calls : 0},
+            {"maxWaitUs", us.waitUsMax},
+            {"avgLatencyUs", calls ? us.latencyUsTotal / calls : 0},
+            {"maxLatencyUs", us.latencyUsMax}
+        };
+        res.set_content(out.dump(), "application/json");
+        });
+
+    // GET /problems  -> lista (almacén nativo o proxy cacheado)
+    svr.Get("/problems", [&mongo](const httplib::Request& req, httplib::Response& res) {
+        set_cors(res);
+        if (NATIVE) {
+            send_entry(req, res, STORE.list());
+            return;
+        }
+        cached_get(mongo, "/problems", req, res);
         });
 
-    // Cliente hacia el microservicio Python (mongo_manager.py en 8081)
-    httplib::Client mongo("localhost", 8081);
+    // GET /problems/<id>  -> detalle (almacén nativo o proxy cacheado)
+    svr.Get(R"(/problems/([A-Za-z0-9\-\_]+))", [&mongo](const httplib::Request& req, httplib::Response& res) {
+        set_cors(res);
+        std::string id = req.matches[1];
+        if (NATIVE) {
+            auto body = STORE.get(id);
+            if (!body) {
+                res.status = 404;
+                res.set_content(R"({"error":"Problem not found"})", "application/json");
+                return;
+            }
+            send_entry(req, res, body);
+            return;
+        }
+        cached_get(mongo, "/problems/" + id, req, res);
+        });
 
-    // GET /problems  -> proxy a Python
-    svr.Get("/problems", [&mongo](const httplib::Request&, httplib::Response& res) {
+    // POST /problems  -> crear problema
+    svr.Post("/problems", [&mongo](const httplib::Request& req, httplib::Response& res) {
         set_cors(res);
 
-        auto pres = mongo.Get("/problems");
+        if (NATIVE) {
+            auto doc = json::parse(req.body, nullptr, false);
+            switch (STORE.create(doc)) {
+            case ProblemStore::PutResult::Created:
+                res.status = 201;
+                res.set_content(json{ {"id", doc["id"]} }.dump(), "application/json");
+                break;
+            case ProblemStore::PutResult::Exists:
+                res.status = 409;
+                res.set_content(json{ {"error", "Problem with id '" + doc["id"].get<std::string>()
+                    + "' already exists"} }.dump(), "application/json");
+                break;
+            case ProblemStore::PutResult::Invalid:
+                res.status = 400;
+                res.set_content(R"({"error":"field 'id' is required"})", "application/json");
+                break;
+            }
+            return;
+        }
+
+        auto pres = mongo.post("/problems", req.body, "application/json");
         if (!pres) {
-            res.status = 500;
-            res.set_content(R"({"error":"mongo_manager no responde en :8081"})", "application/json");
+            upstream_error(res, pres);
             return;
         }
 
+        if (pres->status < 300) {
+            auto body = json::parse(pres->body, nullptr, false);
+            std::string id = body.is_object() ? body.value("id", "") : "";
+            CACHE.invalidate({ "/problems", "/problems/" + id });
+        }
+
         res.status = pres->status;
-        // Siempre devolvemos JSON
         res.set_content(pres->body, "application/json");
         });
 
-    // GET /problems/<id>  -> proxy a Python
-    svr.Get(R"(/problems/([A-Za-z0-9\-\_]+))", [&mongo](const httplib::Request& req, httplib::Response& res) {
+    // DELETE /problems/<id>  -> eliminar problema
+    svr.Delete(R"(/problems/([A-Za-z0-9\-\_]+))", [&mongo](const httplib::Request& req, httplib::Response& res) {
         set_cors(res);
         std::string id = req.matches[1];
 
+        if (NATIVE) {
+            if (!STORE.remove(id)) {
+                res.status = 404;
+                res.set_content(R"({"error":"Problem not found"})", "application/json");
+                return;
+            }
+            res.set_content(json{ {"status", "deleted"}, {"id", id} }.dump(), "application/json");
+            return;
+        }
+
         std::string path = "/problems/" + id;
-        auto pres = mongo.Get(path.c_str());
+        auto pres = mongo.del(path);
         if (!pres) {
-            res.status = 500;
-            res.set_content(R"({"error":"mongo_manager no responde en :8081"})", "application/json");
+            upstream_error(res, pres);
             return;
         }
 
+        if (pres->status < 300) CACHE.invalidate({ "/problems", path });
+
         res.status = pres->status;
         res.set_content(pres->body, "application/json");
         });
 
-    // POST /problems  -> crear problema (proxy a Python)
-    svr.Post("/problems", [&mongo](const httplib::Request& req, httplib::Response& res) {
+    // Importar / exportar entre el almacén nativo y Mongo
+    svr.Post("/admin/import", [&mongo](const httplib::Request&, httplib::Response& res) {
         set_cors(res);
-
-        auto pres = mongo.Post("/problems", req.body, "application/json");
-        if (!pres) {
-            res.status = 500;
-            res.set_content(R"({"error":"mongo_manager no responde en :8081"})", "application/json");
+        if (!NATIVE) {
+            res.status = 409;
+            res.set_content(R"({"error":"backend is mongo"})", "application/json");
             return;
         }
+        json out = import_from_mongo(mongo);
+        if (out.contains("error")) res.status = 502;
+        res.set_content(out.dump(), "application/json");
+        });
 
-        res.status = pres->status;
-        res.set_content(pres->body, "application/json");
+    svr.Post("/admin/export", [&mongo](const httplib::Request&, httplib::Response& res) {
+        set_cors(res);
+        if (!NATIVE) {
+            res.status = 409;
+            res.set_content(R"({"error":"backend is mongo"})", "application/json");
+            return;
+        }
+        json out = export_to_mongo(mongo);
+        if (out.contains("error")) res.status = 502;
+        res.set_content(out.dump(), "application/json");
         });
 
     std::cout << "[PM-CPP] Escuchando en http://0.0.0.0:8084\n";
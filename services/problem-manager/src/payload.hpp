@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "hash128.hpp"
+#include "httplib.h"
+
+#ifdef CC_PM_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CC_PM_BROTLI
+#include <brotli/encode.h>
+#endif
+
+// =========================== PAYLOAD ===========================
+// Respuesta lista para enviar: el JSON ya serializado y, si está disponible
+// zlib/brotli, sus versiones comprimidas calculadas una sola vez al crearla.
+// Se comparte por shared_ptr y se envía sin copiar el cuerpo.
+struct Payload {
+    int status = 200;
+    std::string body;
+    std::string gzip;      // vacío si no compensa o no hay zlib
+    std::string br;        // vacío si no compensa o no hay brotli
+    std::string etag;      // ETag fuerte del cuerpo sin comprimir
+};
+
+using PayloadPtr = std::shared_ptr<const Payload>;
+
+// Por debajo de esto comprimir no ahorra casi nada
+static constexpr size_t PAYLOAD_MIN_COMPRESS = 512;
+
+// ETag fuerte: 64 bits del hash del cuerpo (ver hash128.hpp)
+inline std::string make_etag(const std::string& body) {
+    const uint64_t h = hash128::Hasher().bytes(body).hi();
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "\"%016llx\"", (unsigned long long)h);
+    return buf;
+}
+
+inline std::string gzip_compress(const std::string& in) {
+#ifdef CC_PM_ZLIB
+    z_stream zs{};
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    std::string out(deflateBound(&zs, (uLong)in.size()), '\0');
+    zs.next_in = (Bytef*)in.data();
+    zs.avail_in = (uInt)in.size();
+    zs.next_out = (Bytef*)&out[0];
+    zs.avail_out = (uInt)out.size();
+    int rc = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return rc == Z_STREAM_END ? out : std::string();
+#else
+    (void)in;
+    return {};
+#endif
+}
+
+inline std::string brotli_compress(const std::string& in) {
+#ifdef CC_PM_BROTLI
+    size_t n = BrotliEncoderMaxCompressedSize(in.size());
+    if (n == 0) return {};
+    std::string out(n, '\0');
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+        in.size(), (const uint8_t*)in.data(), &n, (uint8_t*)&out[0])) {
+        return {};
+    }
+    out.resize(n);
+    return out;
+#else
+    (void)in;
+    return {};
+#endif
+}
+
+inline PayloadPtr make_payload(std::string body, int status = 200) {
+    auto p = std::make_shared<Payload>();
+    p->status = status;
+    p->etag = make_etag(body);
+    if (body.size() >= PAYLOAD_MIN_COMPRESS) {
+        p->gzip = gzip_compress(body);
+        p->br = brotli_compress(body);
+        if (p->gzip.size() >= body.size()) p->gzip.clear();
+        if (p->br.size() >= body.size()) p->br.clear();
+    }
+    p->body = std::move(body);
+    return p;
+}
+
+// Calidad (q) de `coding` en un Accept-Encoding; 0 si no se acepta.
+// Una entrada con el nombre exacto manda sobre "*" (RFC 9110 §12.5.3), así
+// "*;q=1, gzip;q=0" rechaza gzip. q solo se lee como parámetro propio ";q=".
+inline double accept_q(const std::string& header, const std::string& coding) {
+    auto trim = [](const std::string& s, size_t b, size_t e) {
+        b = s.find_first_not_of(" \t", b);
+        if (b == std::string::npos || b >= e) return std::string();
+        e = s.find_last_not_of(" \t", e - 1);
+        std::string out = s.substr(b, e - b + 1);
+        for (char& c : out) c = (char)std::tolower((unsigned char)c);
+        return out;
+    };
+    double exact = -1.0, wildcard = -1.0;
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) end = header.size();
+        size_t semi = std::min(header.find(';', pos), end);
+        std::string name = trim(header, pos, semi);
+        if (name == coding || name == "*") {
+            double q = 1.0;
+            while (semi < end) {
+                size_t next = std::min(header.find(';', semi + 1), end);
+                size_t eq = std::min(header.find('=', semi + 1), next);
+                if (eq < next && trim(header, semi + 1, eq) == "q") {
+                    q = std::atof(trim(header, eq + 1, next).c_str());
+                    q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+                }
+                semi = next;
+            }
+            (name == "*" ? wildcard : exact) = q;
+        }
+        pos = end + 1;
+    }
+    if (exact >= 0.0) return exact;
+    return wildcard >= 0.0 ? wildcard : 0.0;
+}
+
+// ¿El If-None-Match del cliente (lista separada por comas o "*") incluye `etag`?
+inline bool etag_matches(const std::string& ifNoneMatch, const std::string& etag) {
+    if (ifNoneMatch.empty()) return false;
+    size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        size_t end = ifNoneMatch.find(',', pos);
+        if (end == std::string::npos) end = ifNoneMatch.size();
+        size_t b = ifNoneMatch.find_first_not_of(" \t", pos);
+        size_t e = ifNoneMatch.find_last_not_of(" \t", end - 1);
+        if (b != std::string::npos && b < end && e >= b) {
+            std::string tag = ifNoneMatch.substr(b, e - b + 1);
+            if (tag.rfind("W/", 0) == 0) tag = tag.substr(2);
+            if (tag == "*" || tag == etag) return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+// Elige la representación según Accept-Encoding, contesta 304 si el cliente
+// ya la tiene y si no la envía desde el buffer compartido, sin copiarla.
+// Devuelve true si respondió 304.
+inline bool send_payload(const httplib::Request& req, httplib::Response& res, const PayloadPtr& p) {
+    const std::string accept = req.get_header_value("Accept-Encoding");
+    const std::string* data = &p->body;
+    std::string etag = p->etag;
+    const char* encoding = nullptr;
+    double qbr = p->br.empty() ? 0.0 : accept_q(accept, "br");
+    double qgz = p->gzip.empty() ? 0.0 : accept_q(accept, "gzip");
+    if (qbr > 0 && qbr >= qgz) {
+        data = &p->br;
+        encoding = "br";
+    }
+    else if (qgz > 0) {
+        data = &p->gzip;
+        encoding = "gzip";
+    }
+    // Cada representación lleva su propio ETag fuerte
+    if (encoding) etag.insert(etag.size() - 1, std::string("-") + encoding);
+
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "no-cache");
+    res.set_header("Vary", "Accept-Encoding");
+    if (etag_matches(req.get_header_value("If-None-Match"), etag)) {
+        res.status = 304;
+        return true;
+    }
+
+    res.status = p->status;
+    if (encoding) res.set_header("Content-Encoding", encoding);
+    res.set_content_provider(data->size(), "application/json",
+        [p, data](size_t offset, size_t length, httplib::DataSink& sink) {
+            return sink.write(data->data() + offset, length);
+        });
+    return false;
+}
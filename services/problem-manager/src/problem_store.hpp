@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "json.hpp"
+#include "payload.hpp"
+
+// ======================== PROBLEM STORE ========================
+// Almacén propio del Problem Manager: un snapshot JSON más un log de
+// cambios (una línea JSON por alta/baja) en `dir`. Al abrir se reproduce
+// el log y se compacta en un snapshot nuevo. En memoria se mantiene el
+// índice por id con el detalle ya serializado (y comprimido) y la proyección
+// de la lista (id, title, difficulty, tags) precalculada, de modo que una
+// lectura es solo copiar un shared_ptr bajo un lock compartido.
+class ProblemStore {
+public:
+    using Body = PayloadPtr;
+
+    enum class PutResult { Created, Exists, Invalid };
+
+    static bool valid_id(const std::string& id) {
+        if (id.empty()) return false;
+        for (char c : id) {
+            if (!std::isalnum((unsigned char)c) && c != '-' && c != '_') return false;
+        }
+        return true;
+    }
+
+    bool open(const std::filesystem::path& dir) {
+        std::unique_lock<std::shared_mutex> lk(m_);
+        dir_ = dir;
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+
+        // Snapshot: arreglo JSON de problemas completos
+        std::ifstream snap(snapshot_path(), std::ios::binary);
+        if (snap) {
+            auto arr = nlohmann::json::parse(snap, nullptr, false);
+            if (arr.is_array()) {
+                for (auto& p : arr) put_locked(p);
+            }
+        }
+
+        // Log: {"op":"put","problem":{...}} | {"op":"del","id":"..."}
+        std::ifstream log(log_path(), std::ios::binary);
+        std::string line;
+        while (std::getline(log, line)) {
+            auto rec = nlohmann::json::parse(line, nullptr, false);
+            if (rec.is_discarded() || !rec.is_object()) continue;   // línea truncada
+            std::string op = rec.value("op", "");
+            if (op == "put" && rec.contains("problem")) put_locked(rec["problem"]);
+            else if (op == "del") erase_locked(rec.value("id", ""));
+        }
+        log.close();
+
+        rebuild_list_locked();
+        return compact_locked();
+    }
+
+    Body list() const {
+        std::shared_lock<std::shared_mutex> lk(m_);
+        return list_;
+    }
+
+    Body get(const std::string& id) const {
+        std::shared_lock<std::shared_mutex> lk(m_);
+        auto it = index_.find(id);
+        return it == index_.end() ? nullptr : it->second.detail;
+    }
+
+    // Copia de todos los documentos, en orden de alta (para exportar)
+    std::vector<nlohmann::json> all() const {
+        std::shared_lock<std::shared_mutex> lk(m_);
+        std::vector<nlohmann::json> out;
+        out.reserve(order_.size());
+        for (const auto& id : order_) out.push_back(index_.at(id).doc);
+        return out;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lk(m_);
+        return order_.size();
+    }
+
+    // Alta de un problema nuevo; no sobrescribe uno existente
+    PutResult create(const nlohmann::json& doc) {
+        if (!doc.is_object() || !doc.contains("id") || !doc["id"].is_string()
+            || !valid_id(doc["id"].get<std::string>())) {
+            return PutResult::Invalid;
+        }
+        std::unique_lock<std::shared_mutex> lk(m_);
+        if (index_.count(doc["id"].get<std::string>())) return PutResult::Exists;
+        put_locked(doc);
+        rebuild_list_locked();
+        append_locked({ {"op", "put"}, {"problem", doc} });
+        return PutResult::Created;
+    }
+
+    bool remove(const std::string& id) {
+        std::unique_lock<std::shared_mutex> lk(m_);
+        if (!erase_locked(id)) return false;
+        rebuild_list_locked();
+        append_locked({ {"op", "del"}, {"id", id} });
+        return true;
+    }
+
+private:
+    struct Item {
+        nlohmann::json doc;
+        Body detail;
+    };
+
+    std::filesystem::path snapshot_path() const { return dir_ / "problems.json"; }
+    std::filesystem::path log_path() const { return dir_ / "problems.log"; }
+
+    static Body make_body(const nlohmann::json& j) { return make_payload(j.dump()); }
+
+    void put_locked(const nlohmann::json& doc) {
+        if (!doc.is_object() || !doc.contains("id") || !doc["id"].is_string()) return;
+        std::string id = doc["id"].get<std::string>();
+        if (!index_.count(id)) order_.push_back(id);
+        index_[id] = Item{ doc, make_body(doc) };
+    }
+
+    bool erase_locked(const std::string& id) {
+        if (index_.erase(id) == 0) return false;
+        order_.erase(std::remove(order_.begin(), order_.end(), id), order_.end());
+        return true;
+    }
+
+    void rebuild_list_locked() {
+        auto arr = nlohmann::json::array();
+        for (const auto& id : order_) {
+            const auto& d = index_.at(id).doc;
+            nlohmann::json s = { {"id", id} };
+            for (const char* k : { "title", "difficulty", "tags" }) {
+                if (d.contains(k)) s[k] = d[k];
+            }
+            arr.push_back(std::move(s));
+        }
+        list_ = make_body(arr);
+    }
+
+    void append_locked(const nlohmann::json& rec) {
+        std::string line = rec.dump() + "\n";
+        std::FILE* f = std::fopen(log_path().string().c_str(), "ab");
+        if (!f) {
+            std::fprintf(stderr, "[PM-CPP] No se pudo escribir %s\n", log_path().string().c_str());
+            return;
+        }
+        std::fwrite(line.data(), 1, line.size(), f);
+        std::fclose(f);
+    }
+
+    // Escribe el snapshot (tmp + rename) y vacía el log
+    bool compact_locked() {
+        auto arr = nlohmann::json::array();
+        for (const auto& id : order_) arr.push_back(index_.at(id).doc);
+        auto tmp = snapshot_path();
+        tmp += ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            f << arr.dump();
+            if (!f) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, snapshot_path(), ec);
+        if (ec) return false;
+        std::filesystem::remove(log_path(), ec);
+        return true;
+    }
+
+    mutable std::shared_mutex m_;
+    std::filesystem::path dir_;
+    std::unordered_map<std::string, Item> index_;
+    std::vector<std::string> order_;       // orden de alta (el mismo que daba Mongo)
+    Body list_;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "payload.hpp"
+
+// ======================= RESPONSE CACHE ========================
+// Caché en memoria de respuestas GET (cuerpo + ETag) por ruta. Cada escritura
+// (POST/DELETE) invalida las rutas afectadas y sube la versión global; un
+// fetch que empezó antes de la invalidación no puede guardar su resultado,
+// así que nunca se reintroduce un cuerpo viejo.
+class ResponseCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t notModified = 0;
+        uint64_t invalidations = 0;
+        uint64_t entries = 0;
+    };
+
+    explicit ResponseCache(std::chrono::seconds ttl = std::chrono::seconds(0)) : ttl_(ttl) {}
+
+    void set_ttl(std::chrono::seconds ttl) { ttl_ = ttl; }
+
+    PayloadPtr get(const std::string& key) {
+        std::lock_guard<std::mutex> lk(m_);
+        auto it = map_.find(key);
+        if (it == map_.end() || expired(it->second)) {
+            if (it != map_.end()) map_.erase(it);
+            ++misses_;
+            return nullptr;
+        }
+        ++hits_;
+        return it->second.entry;
+    }
+
+    // Versión a capturar antes de consultar al origen
+    uint64_t version() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return version_;
+    }
+
+    // Guarda solo si no hubo invalidaciones desde `seenVersion`. La
+    // serialización y compresión se hacen aquí, una vez por entrada.
+    PayloadPtr put(const std::string& key, int status, std::string body, uint64_t seenVersion) {
+        PayloadPtr e = make_payload(std::move(body), status);
+        std::lock_guard<std::mutex> lk(m_);
+        if (seenVersion == version_) {
+            map_[key] = Slot{ e, std::chrono::steady_clock::now() };
+        }
+        return e;
+    }
+
+    void invalidate(std::initializer_list<std::string> keys) {
+        std::lock_guard<std::mutex> lk(m_);
+        ++version_;
+        ++invalidations_;
+        for (const auto& k : keys) map_.erase(k);
+    }
+
+    void count_not_modified() {
+        std::lock_guard<std::mutex> lk(m_);
+        ++notModified_;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return Stats{ hits_, misses_, notModified_, invalidations_, (uint64_t)map_.size() };
+    }
+
+private:
+    struct Slot {
+        PayloadPtr entry;
+        std::chrono::steady_clock::time_point storedAt;
+    };
+
+    bool expired(const Slot& s) const {
+        return ttl_.count() > 0 && std::chrono::steady_clock::now() - s.storedAt >= ttl_;
+    }
+
+    mutable std::mutex m_;
+    std::unordered_map<std::string, Slot> map_;
+    std::chrono::seconds ttl_;
+    uint64_t version_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t notModified_ = 0;
+    uint64_t invalidations_ = 0;
+};
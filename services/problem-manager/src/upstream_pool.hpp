@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "httplib.h"
+
+// ======================== UPSTREAM POOL ========================
+// Pool de conexiones persistentes (keep-alive) hacia mongo_manager.py.
+// Cada llamada toma un cliente libre (esperando como mucho acquireTimeoutMs),
+// y un circuit breaker corta en seco tras `failureThreshold` fallos seguidos:
+// mientras está abierto las llamadas fallan al instante en lugar de dejar
+// colgados los hilos del servidor. Pasado `openMs` deja pasar una sola
+// llamada de prueba (half-open) para decidir si se cierra de nuevo.
+//
+// Errores propios (además de los de red de httplib):
+//   Error::Canceled           circuito abierto, no se intentó la llamada
+//   Error::ResourceExhaustion no hubo conexión libre a tiempo
+class UpstreamPool {
+public:
+    struct Config {
+        std::string host = "localhost";
+        int port = 8081;
+        size_t size = 8;
+        int connectTimeoutMs = 1000;
+        int readTimeoutMs = 5000;
+        int acquireTimeoutMs = 2000;
+        int failureThreshold = 5;
+        int openMs = 10000;
+        // Se llama tras cada llamada real (no las cortadas por el breaker o
+        // sin conexión libre) con su duración y si fue bien
+        std::function<void(double seconds, bool ok)> onCall;
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        uint64_t rejected = 0;          // cortadas por el breaker
+        uint64_t acquireTimeouts = 0;
+        uint64_t waitUsTotal = 0;       // espera por una conexión libre
+        uint64_t waitUsMax = 0;
+        uint64_t latencyUsTotal = 0;    // duración de la llamada al upstream
+        uint64_t latencyUsMax = 0;
+        size_t inUse = 0;
+        size_t size = 0;
+        std::string breaker;            // closed | open | half-open
+    };
+
+    explicit UpstreamPool(const Config& cfg) : cfg_(cfg) {
+        cfg_.size = std::max<size_t>(1, cfg_.size);
+        for (size_t i = 0; i < cfg_.size; ++i) {
+            auto c = std::make_unique<httplib::Client>(cfg_.host, cfg_.port);
+            c->set_keep_alive(true);
+            c->set_connection_timeout(std::chrono::milliseconds(cfg_.connectTimeoutMs));
+            c->set_read_timeout(std::chrono::milliseconds(cfg_.readTimeoutMs));
+            c->set_write_timeout(std::chrono::milliseconds(cfg_.readTimeoutMs));
+            free_.push_back(c.get());
+            clients_.push_back(std::move(c));
+        }
+    }
+
+    httplib::Result get(const std::string& path) {
+        return call([&](httplib::Client& c) { return c.Get(path); });
+    }
+
+    httplib::Result post(const std::string& path, const std::string& body, const char* contentType) {
+        return call([&](httplib::Client& c) { return c.Post(path, body, contentType); });
+    }
+
+    httplib::Result del(const std::string& path) {
+        return call([&](httplib::Client& c) { return c.Delete(path); });
+    }
+
+    const Config& config() const { return cfg_; }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(m_);
+        Stats s = stats_;
+        s.inUse = clients_.size() - free_.size();
+        s.size = clients_.size();
+        s.breaker = state_ == State::Closed ? "closed" : state_ == State::Open ? "open" : "half-open";
+        return s;
+    }
+
+private:
+    enum class State { Closed, Open, HalfOpen };
+    using Clock = std::chrono::steady_clock;
+
+    template <class F>
+    httplib::Result call(F&& f) {
+        httplib::Client* client = nullptr;
+        bool probe = false;
+        const auto t0 = Clock::now();
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            ++stats_.requests;
+
+            if (state_ == State::Open && t0 >= openUntil_) {
+                state_ = State::HalfOpen;
+                probeInFlight_ = false;
+            }
+            if (state_ == State::Open || (state_ == State::HalfOpen && probeInFlight_)) {
+                ++stats_.rejected;
+                return httplib::Result(nullptr, httplib::Error::Canceled);
+            }
+            if (state_ == State::HalfOpen) {
+                probeInFlight_ = true;
+                probe = true;
+            }
+
+            if (!freeCv_.wait_for(lk, std::chrono::milliseconds(cfg_.acquireTimeoutMs),
+                [&] { return !free_.empty(); })) {
+                ++stats_.acquireTimeouts;
+                if (probe) probeInFlight_ = false;
+                return httplib::Result(nullptr, httplib::Error::ResourceExhaustion);
+            }
+            client = free_.back();
+            free_.pop_back();
+        }
+
+        const auto t1 = Clock::now();
+        httplib::Result r = f(*client);
+        const auto t2 = Clock::now();
+        const bool ok = r && r->status < 500;
+
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            free_.push_back(client);
+            record(stats_.waitUsTotal, stats_.waitUsMax, t1 - t0);
+            record(stats_.latencyUsTotal, stats_.latencyUsMax, t2 - t1);
+            if (ok) {
+                consecutiveFailures_ = 0;
+                state_ = State::Closed;
+            }
+            else {
+                ++stats_.failures;
+                ++consecutiveFailures_;
+                if (probe || consecutiveFailures_ >= cfg_.failureThreshold) {
+                    state_ = State::Open;
+                    openUntil_ = Clock::now() + std::chrono::milliseconds(cfg_.openMs);
+                }
+            }
+            if (probe) probeInFlight_ = false;
+        }
+        freeCv_.notify_one();
+        if (cfg_.onCall) cfg_.onCall(std::chrono::duration<double>(t2 - t1).count(), ok);
+        return r;
+    }
+
+    static void record(uint64_t& total, uint64_t& max, Clock::duration d) {
+        uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        total += us;
+        max = std::max(max, us);
+    }
+
+    Config cfg_;
+    std::vector<std::unique_ptr<httplib::Client>> clients_;
+
+    mutable std::mutex m_;
+    std::condition_variable freeCv_;
+    std::vector<httplib::Client*> free_;
+    State state_ = State::Closed;
+    int consecutiveFailures_ = 0;
+    bool probeInFlight_ = false;
+    Clock::time_point openUntil_{};
+    Stats stats_;
+};
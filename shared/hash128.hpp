@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// ============================= HASH ============================
+// Hash de contenido de 128 bits para claves de caché y ETags (no es
+// criptográfico). Son dos carriles independientes: FNV-1a de 64 bits y uno
+// multiplicativo con otra constante y un desplazamiento por byte. Cada carril
+// se cierra con el finalizador de MurmurHash3 para que cada bit de entrada
+// afecte a todos los de salida. Lo comparten la caché de compilación del
+// Evaluator, la de análisis del Analyzer y los ETag del Problem Manager.
+
+namespace hash128 {
+
+class Hasher {
+public:
+    Hasher& bytes(const void* data, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; ++i) {
+            a_ = (a_ ^ p[i]) * 0x100000001b3ULL;
+            b_ = (b_ ^ p[i]) * 0x9e3779b97f4a7c15ULL;
+            b_ ^= b_ >> 31;
+        }
+        return *this;
+    }
+
+    Hasher& bytes(std::string_view s) { return bytes(s.data(), s.size()); }
+
+    // Parte precedida de su longitud, para que ("ab","c") != ("a","bc")
+    Hasher& part(std::string_view s) {
+        const uint64_t len = s.size();
+        bytes(&len, sizeof(len));
+        return bytes(s);
+    }
+
+    uint64_t hi() const { return fmix(a_); }
+    uint64_t lo() const { return fmix(b_); }
+
+    // 32 caracteres hexadecimales
+    std::string hex() const {
+        char buf[33];
+        std::snprintf(buf, sizeof(buf), "%016llx%016llx", (unsigned long long)hi(), (unsigned long long)lo());
+        return buf;
+    }
+
+private:
+    static uint64_t fmix(uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    uint64_t a_ = 0xcbf29ce484222325ULL;
+    uint64_t b_ = 0x84222325cbf29ce4ULL;
+};
+
+} // namespace hash128
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "httplib.h"
+#include "metrics.hpp"
+
+// ======================== MÉTRICAS HTTP ========================
+// Instrumenta un httplib::Server sin tocar los handlers: el post-routing
+// handler ve la ruta que casó (`matched_route`, el patrón y no la URL, así
+// que los ids no disparan la cardinalidad) y la hora de llegada de la
+// petición. Mide el tiempo del handler; lo que un content provider siga
+// enviando después (SSE, cuerpos grandes) no cuenta. httplib admite un solo
+// post-routing handler: `next` permite encadenar otro (p. ej. las trazas).
+// También publica GET /metrics con todo el registro.
+
+namespace metrics {
+
+inline void instrument(httplib::Server& svr, Registry& reg = registry(),
+    httplib::Server::Handler next = nullptr) {
+    auto& requests = reg.counter_family("http_requests_total",
+        "Peticiones HTTP atendidas", { "method", "route", "code" });
+    auto& latency = reg.histogram_family("http_request_duration_seconds",
+        "Tiempo de los handlers HTTP", { "method", "route" });
+
+    svr.set_post_routing_handler([&requests, &latency, next](const httplib::Request& req, httplib::Response& res) {
+        const std::string route = req.matched_route.empty() ? "unmatched" : req.matched_route;
+        requests.with({ req.method, route, std::to_string(res.status) }).inc();
+        if (req.start_time_ != (std::chrono::steady_clock::time_point::min)()) {
+            latency.with({ req.method, route }).observe(std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - req.start_time_).count());
+        }
+        if (next) next(req, res);
+        });
+
+    svr.Get("/metrics", [&reg](const httplib::Request&, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_content(reg.render(), "text/plain; version=0.0.4");
+        });
+}
+
+} // namespace metrics
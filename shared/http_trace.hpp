@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "httplib.h"
+#include "json.hpp"
+#include "trace.hpp"
+
+// ========================= TRAZAS HTTP =========================
+// Span de servidor por petición sin tocar los handlers: su id se deriva de
+// la propia petición (dirección + hora de llegada), de modo que el handler
+// puede colgar sus spans hijos con request_context(req) y el post-routing
+// hook, que ve la misma petición, registra el span padre al terminar.
+// La respuesta lleva `traceresponse` con ese contexto para que el cliente
+// pueda buscar la traza en GET /traces?traceId=...
+
+namespace trace {
+
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x ? x : 1;
+}
+
+// Contexto del span de servidor de `req` (hijo del traceparent entrante)
+inline Context request_context(const httplib::Request& req) {
+    const uint64_t seed = (uint64_t)(uintptr_t)&req
+        ^ (uint64_t)req.start_time_.time_since_epoch().count();
+    Context c = parse_traceparent(req.get_header_value("traceparent"));
+    if (!c.valid()) {
+        c.traceHi = mix64(seed ^ 0x1111);
+        c.traceLo = mix64(seed ^ 0x2222);
+        c.sampled = true;
+    }
+    c.spanId = mix64(seed);
+    return c;
+}
+
+// Para el post-routing hook: guarda el span de servidor de la petición
+inline void record_request(const httplib::Request& req, httplib::Response& res) {
+    Tracer& t = tracer();
+    if (!t.enabled() || req.start_time_ == (std::chrono::steady_clock::time_point::min)()) return;
+
+    SpanRecord r;
+    r.ctx = request_context(req);
+    r.parentId = parse_traceparent(req.get_header_value("traceparent")).spanId;
+    r.name = req.method + " " + (req.matched_route.empty() ? req.path : req.matched_route);
+    auto dur = std::chrono::steady_clock::now() - req.start_time_;
+    r.durUs = std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+    r.startUs = now_us() - r.durUs;
+    r.attrs.emplace_back("http.status", res.status);
+    r.attrs.emplace_back("http.path", req.path);
+    res.set_header("traceresponse", r.ctx.traceparent());
+    t.record(std::move(r));
+}
+
+// GET /traces?traceId=<32 hex>&limit=<n>
+inline void serve_traces(httplib::Server& svr) {
+    svr.Get("/traces", [](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        size_t limit = 200;
+        if (req.has_param("limit")) {
+            limit = (size_t)std::strtoull(req.get_param_value("limit").c_str(), nullptr, 10);
+        }
+        limit = std::clamp<size_t>(limit, 1, 10000);
+        nlohmann::json out = {
+            {"service", tracer().service()},
+            {"spans", tracer().dump(req.get_param_value("traceId"), limit)}
+        };
+        res.set_content(out.dump(), "application/json");
+        });
+}
+
+} // namespace trace
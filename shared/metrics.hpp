@@ -0,0 +1,333 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// =========================== MÉTRICAS ==========================
+// Métricas estilo Prometheus compartidas por los tres servicios C++.
+// Registrar es cosa del arranque (con lock); actualizar es una operación
+// atómica relaxed sin locks, así que se puede llamar desde cualquier hilo
+// en el camino caliente. Las series con etiquetas viven en una tabla de
+// tamaño fijo con punteros atómicos: buscar o crear una serie tampoco toma
+// locks, y una vez creada nunca se libera (las etiquetas deben ser de
+// cardinalidad baja: rutas, veredictos, códigos HTTP).
+// `Registry::render()` produce el formato de texto 0.0.4 de /metrics.
+
+namespace metrics {
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { v_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return v_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> v_{ 0 };
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { v_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { v_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return v_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> v_{ 0 };
+};
+
+// Histograma acumulativo con límites fijos (en segundos para latencias)
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds)
+        : bounds_(std::move(bounds)), buckets_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+        for (size_t i = 0; i <= bounds_.size(); ++i) buckets_[i].store(0, std::memory_order_relaxed);
+    }
+
+    void observe(double v) {
+        size_t i = 0;
+        while (i < bounds_.size() && v > bounds_[i]) ++i;
+        buckets_[i].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        // La suma es double: se acumula con CAS sobre su patrón de bits
+        uint64_t old = sum_.load(std::memory_order_relaxed), next;
+        do {
+            double d;
+            std::memcpy(&d, &old, sizeof d);
+            d += v;
+            std::memcpy(&next, &d, sizeof d);
+        } while (!sum_.compare_exchange_weak(old, next, std::memory_order_relaxed));
+    }
+
+    const std::vector<double>& bounds() const { return bounds_; }
+    uint64_t bucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double sum() const {
+        uint64_t bits = sum_.load(std::memory_order_relaxed);
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        return d;
+    }
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;   // el último es +Inf
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_{ 0 };                      // bits de un double (0 == 0.0)
+};
+
+// Límites por defecto para latencias: de 1 ms a 30 s
+inline std::vector<double> latency_buckets() {
+    return { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+}
+
+// Conjunto de series de una métrica con etiquetas, p. ej. {method, route}.
+// `with()` busca la serie en una tabla abierta de CAPACITY punteros
+// atómicos; si la tabla se llena, lo que no cabe va a una serie de desborde.
+template <class T>
+class Family {
+public:
+    static constexpr size_t CAPACITY = 256;
+    using Labels = std::vector<std::string>;
+
+    Family(Labels names, std::function<T*()> make)
+        : names_(std::move(names)), make_(std::move(make)), overflow_(make_()) {
+        for (auto& s : slots_) s.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~Family() {
+        for (auto& s : slots_) delete s.load(std::memory_order_relaxed);
+    }
+
+    T& with(const Labels& values) {
+        const std::string key = join(values);
+        const size_t h = std::hash<std::string>{}(key);
+        Series* mine = nullptr;
+        for (size_t k = 0; k < CAPACITY; ++k) {
+            auto& slot = slots_[(h + k) % CAPACITY];
+            Series* cur = slot.load(std::memory_order_acquire);
+            if (!cur) {
+                if (!mine) mine = new Series{ key, values, std::unique_ptr<T>(make_()) };
+                if (slot.compare_exchange_strong(cur, mine, std::memory_order_acq_rel)) return *mine->metric;
+                // Otro hilo ocupó el hueco: `cur` es ahora su serie
+            }
+            if (cur->key == key) {
+                delete mine;
+                return *cur->metric;
+            }
+        }
+        delete mine;
+        return *overflow_;
+    }
+
+    const Labels& names() const { return names_; }
+
+    // Recorre las series existentes (para render)
+    template <class F>
+    void each(F&& f) const {
+        for (const auto& s : slots_) {
+            if (const Series* p = s.load(std::memory_order_acquire)) f(p->values, *p->metric);
+        }
+    }
+
+private:
+    struct Series {
+        std::string key;
+        Labels values;
+        std::unique_ptr<T> metric;
+    };
+
+    static std::string join(const Labels& v) {
+        std::string k;
+        for (const auto& s : v) {
+            k += s;
+            k += '\x1f';
+        }
+        return k;
+    }
+
+    Labels names_;
+    std::function<T*()> make_;
+    std::unique_ptr<T> overflow_;
+    std::atomic<Series*> slots_[CAPACITY];
+};
+
+class Registry {
+public:
+    Counter& counter(const std::string& name, const std::string& help) {
+        return add<Counter>(name, help, "counter", new Counter());
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help) {
+        return add<Gauge>(name, help, "gauge", new Gauge());
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help,
+        std::vector<double> bounds = latency_buckets()) {
+        return add<Histogram>(name, help, "histogram", new Histogram(std::move(bounds)));
+    }
+
+    Family<Counter>& counter_family(const std::string& name, const std::string& help,
+        std::vector<std::string> labels) {
+        return add<Family<Counter>>(name, help, "counter",
+            new Family<Counter>(std::move(labels), [] { return new Counter(); }));
+    }
+
+    Family<Histogram>& histogram_family(const std::string& name, const std::string& help,
+        std::vector<std::string> labels, std::vector<double> bounds = latency_buckets()) {
+        return add<Family<Histogram>>(name, help, "histogram",
+            new Family<Histogram>(std::move(labels), [bounds] { return new Histogram(bounds); }));
+    }
+
+    // Valores que ya lleva otro componente (tamaño de una cola, aciertos de
+    // una caché...): se leen al generar /metrics en vez de duplicarlos
+    void gauge_fn(const std::string& name, const std::string& help, std::function<double()> f) {
+        add_fn(name, help, "gauge", std::move(f));
+    }
+
+    void counter_fn(const std::string& name, const std::string& help, std::function<double()> f) {
+        add_fn(name, help, "counter", std::move(f));
+    }
+
+    std::string render() const {
+        std::lock_guard<std::mutex> lk(m_);
+        std::string out;
+        out.reserve(4096);
+        for (const auto& e : entries_) {
+            out += "# HELP " + e.name + " " + e.help + "\n";
+            out += "# TYPE " + e.name + " " + e.type + "\n";
+            e.render(out, e.name);
+        }
+        return out;
+    }
+
+private:
+    struct Entry {
+        std::string name, help, type;
+        std::shared_ptr<void> owner;
+        std::function<void(std::string&, const std::string&)> render;
+    };
+
+    template <class T>
+    T& add(const std::string& name, const std::string& help, const char* type, T* m) {
+        std::shared_ptr<T> p(m);
+        std::lock_guard<std::mutex> lk(m_);
+        entries_.push_back(Entry{ name, help, type, p,
+            [m](std::string& out, const std::string& n) { write(out, n, *m); } });
+        return *m;
+    }
+
+    void add_fn(const std::string& name, const std::string& help, const char* type,
+        std::function<double()> f) {
+        std::lock_guard<std::mutex> lk(m_);
+        entries_.push_back(Entry{ name, help, type, nullptr,
+            [f](std::string& out, const std::string& n) { out += n + " " + num(f()) + "\n"; } });
+    }
+
+    static std::string num(double v) {
+        if (std::isinf(v)) return v > 0 ? "+Inf" : "-Inf";
+        if (std::isnan(v)) return "NaN";
+        char b[32];
+        std::snprintf(b, sizeof(b), "%.10g", v);
+        return b;
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string o;
+        for (char c : s) {
+            if (c == '\\' || c == '"') o += '\\';
+            if (c == '\n') { o += "\\n"; continue; }
+            o += c;
+        }
+        return o;
+    }
+
+    // {a="x",b="y"} más, opcionalmente, una etiqueta extra (le="..." en los buckets)
+    static std::string labels(const std::vector<std::string>& names, const std::vector<std::string>& values,
+        const std::string& extra = "") {
+        std::string o;
+        for (size_t i = 0; i < names.size() && i < values.size(); ++i) {
+            o += o.empty() ? "{" : ",";
+            o += names[i] + "=\"" + escape(values[i]) + "\"";
+        }
+        if (!extra.empty()) o += (o.empty() ? "{" : ",") + extra;
+        return o.empty() ? o : o + "}";
+    }
+
+    static void write(std::string& out, const std::string& n, const Counter& c,
+        const std::string& lbl = "") {
+        out += n + lbl + " " + std::to_string(c.value()) + "\n";
+    }
+
+    static void write(std::string& out, const std::string& n, const Gauge& g) {
+        out += n + " " + std::to_string(g.value()) + "\n";
+    }
+
+    static void write_hist(std::string& out, const std::string& n, const Histogram& h,
+        const std::vector<std::string>& names, const std::vector<std::string>& values) {
+        uint64_t acc = 0;
+        const auto& b = h.bounds();
+        for (size_t i = 0; i <= b.size(); ++i) {
+            acc += h.bucket(i);
+            std::string le = "le=\"" + (i < b.size() ? num(b[i]) : std::string("+Inf")) + "\"";
+            out += n + "_bucket" + labels(names, values, le) + " " + std::to_string(acc) + "\n";
+        }
+        out += n + "_sum" + labels(names, values) + " " + num(h.sum()) + "\n";
+        out += n + "_count" + labels(names, values) + " " + std::to_string(h.count()) + "\n";
+    }
+
+    static void write(std::string& out, const std::string& n, const Histogram& h) {
+        write_hist(out, n, h, {}, {});
+    }
+
+    static void write(std::string& out, const std::string& n, const Family<Counter>& f) {
+        f.each([&](const std::vector<std::string>& values, const Counter& c) {
+            write(out, n, c, labels(f.names(), values));
+            });
+    }
+
+    static void write(std::string& out, const std::string& n, const Family<Histogram>& f) {
+        f.each([&](const std::vector<std::string>& values, const Histogram& h) {
+            write_hist(out, n, h, f.names(), values);
+            });
+    }
+
+    mutable std::mutex m_;
+    std::vector<Entry> entries_;
+};
+
+// Registro único del proceso
+inline Registry& registry() {
+    static Registry R;
+    return R;
+}
+
+// Hilos y memoria residente del proceso (Linux: /proc/self/status)
+inline void register_process_metrics(Registry& r) {
+#ifdef __linux__
+    auto status_field = [](const char* field) -> double {
+        std::ifstream f("/proc/self/status");
+        std::string line;
+        const size_t len = std::strlen(field);
+        while (std::getline(f, line)) {
+            if (line.compare(0, len, field) == 0) return std::atof(line.c_str() + len);
+        }
+        return 0;
+    };
+    r.gauge_fn("process_threads", "Hilos del proceso",
+        [status_field] { return status_field("Threads:"); });
+    r.gauge_fn("process_resident_memory_bytes", "Memoria residente del proceso",
+        [status_field] { return status_field("VmRSS:") * 1024; });
+#else
+    (void)r;
+#endif
+}
+
+} // namespace metrics
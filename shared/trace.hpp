@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json.hpp"
+
+// ============================ TRAZAS ===========================
+// Spans compatibles con W3C Trace Context: el contexto viaja en la cabecera
+// `traceparent` ("00-<trace id>-<span id>-<flags>") entre la UI y los
+// servicios, así que un mismo envío se puede seguir del Evaluator al
+// Analyzer y al proxy LLM. Cada span terminado va a un ring buffer en
+// memoria (GET /traces) y, si se configura, a un fichero JSON por línea.
+// Abrir un span cuesta dos lecturas de reloj y un id aleatorio; solo al
+// cerrarlo se toma un lock muy corto para guardarlo.
+
+namespace trace {
+
+struct Context {
+    uint64_t traceHi = 0, traceLo = 0;
+    uint64_t spanId = 0;
+    bool sampled = true;
+
+    bool valid() const { return (traceHi | traceLo) != 0 && spanId != 0; }
+
+    std::string trace_id() const { return hex(traceHi) + hex(traceLo); }
+
+    std::string traceparent() const {
+        return "00-" + trace_id() + "-" + hex(spanId) + (sampled ? "-01" : "-00");
+    }
+
+    static std::string hex(uint64_t v) {
+        char b[17];
+        std::snprintf(b, sizeof(b), "%016llx", (unsigned long long)v);
+        return b;
+    }
+};
+
+inline bool parse_hex(const std::string& s, size_t pos, size_t len, uint64_t& out) {
+    out = 0;
+    for (size_t i = pos; i < pos + len; ++i) {
+        char c = s[i];
+        int d = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+        if (d < 0) return false;
+        out = (out << 4) | (uint64_t)d;
+    }
+    return true;
+}
+
+// Contexto vacío (inválido) si la cabecera no es un traceparent versión 00
+inline Context parse_traceparent(const std::string& h) {
+    Context c;
+    uint64_t flags = 0;
+    if (h.size() < 55 || h.compare(0, 3, "00-") != 0 || h[35] != '-' || h[52] != '-') return c;
+    if (!parse_hex(h, 3, 16, c.traceHi) || !parse_hex(h, 19, 16, c.traceLo)
+        || !parse_hex(h, 36, 16, c.spanId) || !parse_hex(h, 53, 2, flags)) {
+        return Context{};
+    }
+    c.sampled = (flags & 1) != 0;
+    return c.valid() ? c : Context{};
+}
+
+// Ids aleatorios sin locks: un generador por hilo
+inline uint64_t random_id() {
+    thread_local std::mt19937_64 rng{ std::random_device{}() };
+    uint64_t v;
+    do v = rng(); while (v == 0);
+    return v;
+}
+
+// Hijo de `parent`, o raíz de una traza nueva si no hay padre
+inline Context child_of(const Context& parent) {
+    Context c = parent;
+    if (!parent.valid()) {
+        c.traceHi = random_id();
+        c.traceLo = random_id();
+        c.sampled = true;
+    }
+    c.spanId = random_id();
+    return c;
+}
+
+struct SpanRecord {
+    Context ctx;
+    uint64_t parentId = 0;
+    std::string name;
+    int64_t startUs = 0;        // epoch
+    int64_t durUs = 0;
+    std::vector<std::pair<std::string, nlohmann::json>> attrs;
+
+    nlohmann::json to_json(const std::string& service) const {
+        nlohmann::json a = nlohmann::json::object();
+        for (const auto& kv : attrs) a[kv.first] = kv.second;
+        nlohmann::json j = {
+            {"traceId", ctx.trace_id()},
+            {"spanId", Context::hex(ctx.spanId)},
+            {"name", name},
+            {"service", service},
+            {"startUs", startUs},
+            {"durUs", durUs},
+            {"attrs", std::move(a)}
+        };
+        if (parentId) j["parentId"] = Context::hex(parentId);
+        return j;
+    }
+};
+
+class Tracer {
+public:
+    struct Config {
+        std::string service;
+        bool enabled = true;
+        size_t capacity = 4096;     // spans en el ring buffer
+        std::string file;           // "" = sin fichero
+    };
+
+    ~Tracer() {
+        if (file_) std::fclose(file_);
+    }
+
+    void start(const Config& cfg) {
+        std::lock_guard<std::mutex> lk(m_);
+        cfg_ = cfg;
+        ring_.assign(cfg_.enabled ? std::max<size_t>(1, cfg_.capacity) : 0, SpanRecord{});
+        head_ = size_ = 0;
+        if (cfg_.enabled && !cfg_.file.empty()) file_ = std::fopen(cfg_.file.c_str(), "a");
+    }
+
+    bool enabled() const { return cfg_.enabled; }
+    const std::string& service() const { return cfg_.service; }
+
+    void record(SpanRecord&& r) {
+        if (!cfg_.enabled || !r.ctx.sampled) return;
+        std::string line;
+        if (file_) line = r.to_json(cfg_.service).dump() + "\n";
+        std::lock_guard<std::mutex> lk(m_);
+        if (ring_.empty()) return;
+        ring_[head_] = std::move(r);
+        head_ = (head_ + 1) % ring_.size();
+        if (size_ < ring_.size()) ++size_;
+        if (file_) {
+            std::fputs(line.c_str(), file_);
+            std::fflush(file_);
+        }
+    }
+
+    // Spans del buffer, del más reciente al más antiguo; `traceId` filtra
+    nlohmann::json dump(const std::string& traceId, size_t limit) const {
+        nlohmann::json out = nlohmann::json::array();
+        std::lock_guard<std::mutex> lk(m_);
+        for (size_t k = 0; k < size_ && out.size() < limit; ++k) {
+            const SpanRecord& r = ring_[(head_ + ring_.size() - 1 - k) % ring_.size()];
+            if (!traceId.empty() && r.ctx.trace_id() != traceId) continue;
+            out.push_back(r.to_json(cfg_.service));
+        }
+        return out;
+    }
+
+private:
+    Config cfg_;
+    mutable std::mutex m_;
+    std::vector<SpanRecord> ring_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    std::FILE* file_ = nullptr;
+};
+
+// Tracer único del proceso
+inline Tracer& tracer() {
+    static Tracer T;
+    return T;
+}
+
+inline int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Span con alcance: empieza al construirse y se guarda al destruirse (o en end())
+class Span {
+public:
+    Span(std::string name, const Context& parent)
+        : active_(tracer().enabled()), parentId_(parent.valid() ? parent.spanId : 0) {
+        ctx_ = active_ ? child_of(parent) : parent;
+        if (!active_) return;
+        name_ = std::move(name);
+        startUs_ = now_us();
+        t0_ = std::chrono::steady_clock::now();
+    }
+
+    // Span que empezó antes de poder crearlo (p. ej. la espera en una cola)
+    Span(std::string name, const Context& parent, std::chrono::steady_clock::time_point started)
+        : Span(std::move(name), parent) {
+        if (!active_) return;
+        startUs_ -= std::chrono::duration_cast<std::chrono::microseconds>(t0_ - started).count();
+        t0_ = started;
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    ~Span() { end(); }
+
+    const Context& context() const { return ctx_; }
+
+    Span& attr(const std::string& key, nlohmann::json value) {
+        if (active_) attrs_.emplace_back(key, std::move(value));
+        return *this;
+    }
+
+    void end() {
+        if (!active_) return;
+        active_ = false;
+        SpanRecord r;
+        r.ctx = ctx_;
+        r.parentId = parentId_;
+        r.name = std::move(name_);
+        r.startUs = startUs_;
+        r.durUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0_).count();
+        r.attrs = std::move(attrs_);
+        tracer().record(std::move(r));
+    }
+
+private:
+    bool active_;
+    Context ctx_;
+    uint64_t parentId_;
+    std::string name_;
+    int64_t startUs_ = 0;
+    std::chrono::steady_clock::time_point t0_{};
+    std::vector<std::pair<std::string, nlohmann::json>> attrs_;
+};
+
+} // namespace trace
@@ -18,11 +18,11 @@ const AN_BASE = 'http://localhost:8083' // Analyzer (C++ que llama al LLM)
 // Helper genérico para llamadas JSON
 async function jsonFetch<T>(url: string, init?: RequestInit): Promise<T> {
   const res = await fetch(url, {
+    ...init,
     headers: {
       'Content-Type': 'application/json',
       ...(init && init.headers ? init.headers : {}),
     },
-    ...init,
   })
 
   if (!res.ok) {
@@ -37,6 +37,19 @@ async function jsonFetch<T>(url: string, init?: RequestInit): Promise<T> {
   return (await res.json()) as T
 }
 
+// Cabecera W3C `traceparent` para seguir un envío de punta a punta: la misma
+// traza se reutiliza al pedir el análisis, y cada servicio guarda sus spans
+// (consultables en GET /traces?traceId=... de cada uno)
+export function newTraceparent(): string {
+  const hex = (n: number) =>
+    Array.from(crypto.getRandomValues(new Uint8Array(n)), (b) => b.toString(16).padStart(2, '0')).join('')
+  return `00-${hex(16)}-${hex(8)}-01`
+}
+
+function traceHeaders(traceparent?: string): Record<string, string> {
+  return traceparent ? { traceparent } : {}
+}
+
 // =====================
 //  Problem Manager (PM)
 // =====================
@@ -66,9 +79,10 @@ export async function deleteProblem(id: string): Promise<void> {
 //  Evaluator (EV)
 // =================
 
-export async function submitSolution(body: PostSubmissionReq): Promise<PostSubmissionRes> {
+export async function submitSolution(body: PostSubmissionReq, traceparent?: string): Promise<PostSubmissionRes> {
   return jsonFetch<PostSubmissionRes>(`${EV_BASE}/submissions`, {
     method: 'POST',
+    headers: traceHeaders(traceparent),
     body: JSON.stringify(body),
   })
 }
@@ -77,17 +91,92 @@ export async function getSubmission(id: string): Promise<SubmissionStatus> {
   return jsonFetch<SubmissionStatus>(`${EV_BASE}/submissions/${encodeURIComponent(id)}`)
 }
 
+// Stream SSE con cada cambio de estado; llama a onStatus por evento y
+// devuelve la función para cerrarlo. onError se llama si el stream se cae.
+export function watchSubmission(
+  id: string,
+  onStatus: (s: SubmissionStatus) => void,
+  onError: () => void,
+): () => void {
+  const es = new EventSource(`${EV_BASE}/submissions/${encodeURIComponent(id)}/events`)
+  es.addEventListener('status', (ev) => {
+    const s = JSON.parse((ev as MessageEvent).data) as SubmissionStatus
+    onStatus(s)
+    if (s.status === 'done') es.close()
+  })
+  es.onerror = () => {
+    es.close()
+    onError()
+  }
+  return () => es.close()
+}
+
 // =================
 //  Analyzer (AN)
 // =================
 
-export async function analyzeSolution(body: AnalysisReq): Promise<AnalysisRes> {
+export async function analyzeSolution(body: AnalysisReq, traceparent?: string): Promise<AnalysisRes> {
   return jsonFetch<AnalysisRes>(`${AN_BASE}/analysis`, {
     method: 'POST',
+    headers: traceHeaders(traceparent),
     body: JSON.stringify(body),
   })
 }
 
+type AnalysisJob = { status: string; version: number; lines: string[]; error?: string }
+
+// Stream SSE con las líneas de la IA según llegan; onEnd recibe el estado
+// final ('done' | 'error'). Si el stream falla (p. ej. 503 porque el Analyzer
+// ya tiene demasiados abiertos) sigue consultando el trabajo cada 2 s.
+// Devuelve la función para cerrarlo.
+export function watchAnalysisJob(
+  jobId: string,
+  onLine: (line: string) => void,
+  onEnd: (status: string, error?: string) => void,
+): () => void {
+  const url = `${AN_BASE}/analysis/jobs/${encodeURIComponent(jobId)}`
+  let seen = 0 // líneas ya entregadas
+  let stopped = false
+  let timer: ReturnType<typeof setTimeout> | undefined
+
+  const poll = async () => {
+    try {
+      const j = await jsonFetch<AnalysisJob>(url)
+      if (stopped) return
+      for (; seen < j.lines.length; seen++) onLine(j.lines[seen])
+      if (j.status === 'done' || j.status === 'error') {
+        onEnd(j.status, j.error)
+        return
+      }
+    } catch {
+      if (stopped) return
+      onEnd('error', 'Se perdió la conexión con el Analyzer.')
+      return
+    }
+    timer = setTimeout(poll, 2000)
+  }
+
+  const es = new EventSource(`${url}/events`)
+  es.addEventListener('line', (ev) => {
+    seen++
+    onLine(JSON.parse((ev as MessageEvent).data) as string)
+  })
+  es.addEventListener('end', (ev) => {
+    const e = JSON.parse((ev as MessageEvent).data) as { status: string; error?: string }
+    es.close()
+    onEnd(e.status, e.error)
+  })
+  es.onerror = () => {
+    es.close()
+    if (!stopped) poll()
+  }
+  return () => {
+    stopped = true
+    es.close()
+    if (timer) clearTimeout(timer)
+  }
+}
+
 // Re-export de tipos útiles para que puedas hacer:
 //   import { listProblems, type ProblemSummary } from '../api/clients'
 export type {
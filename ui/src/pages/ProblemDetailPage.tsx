@@ -1,10 +1,10 @@
 import { useParams, useNavigate } from 'react-router-dom'
 import { useQuery, useMutation } from '@tanstack/react-query'
-import { getProblem, submitSolution } from '../api/clients'
+import { getProblem, submitSolution, newTraceparent } from '../api/clients'
 import { useState, useEffect } from 'react'
 import CodeEditor from '../components/CodeEditor'
 
-type SubmissionCreated = { submissionId: string }
+type SubmissionCreated = { submissionId: string; traceparent: string }
 
 export default function ProblemDetailPage() {
   const { id } = useParams()
@@ -49,6 +49,7 @@ int main() {
 
   const [source, setSource] = useState<string>('')      // se llena luego
   const [initialized, setInitialized] = useState(false) // para no pisar cambios del usuario
+  const [measureComplexity, setMeasureComplexity] = useState(false)
 
   const { data: problem, isLoading, error } = useQuery({
     queryKey: ['problem', id],
@@ -67,11 +68,17 @@ int main() {
   }, [initialized, problem, id])
 
   const submit = useMutation<SubmissionCreated, Error, void>({
-    mutationFn: async () => submitSolution({ problemId: id!, lang, source }),
+    mutationFn: async () => {
+      const traceparent = newTraceparent()
+      const res = await submitSolution({ problemId: id!, lang, source, measureComplexity }, traceparent)
+      return { ...res, traceparent }
+    },
     onSuccess: (res) => {
       const url = `/submissions/${res.submissionId}?problemId=${id}`
       console.log('🚀 NAVEGANDO A:', url)
-      nav(url)
+      // El código viaja con la navegación para que el Analyzer lo estudie,
+      // junto con la traza del envío para que el análisis cuelgue de ella
+      nav(url, { state: { source, traceparent: res.traceparent } })
     },
   })
 
@@ -109,7 +116,7 @@ int main() {
         />
       </section>
 
-      <div>
+      <div style={{ display: 'flex', gap: 16, alignItems: 'center' }}>
         <button
           onClick={() => submit.mutate()}
           disabled={submit.isPending}
@@ -117,6 +124,14 @@ int main() {
         >
           {submit.isPending ? 'Enviando…' : 'Enviar'}
         </button>
+        <label style={{ fontSize: 14 }}>
+          <input
+            type="checkbox"
+            checked={measureComplexity}
+            onChange={(e) => setMeasureComplexity(e.target.checked)}
+          />{' '}
+          Medir complejidad (tarda unos segundos más)
+        </label>
       </div>
     </div>
   )
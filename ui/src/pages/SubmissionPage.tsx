@@ -1,19 +1,24 @@
-import { useParams, useNavigate } from 'react-router-dom'
-import { useQuery } from '@tanstack/react-query'
-import { getSubmission, analyzeSolution } from '../api/clients'
+import { useParams, useNavigate, useLocation } from 'react-router-dom'
+import { useQuery, useQueryClient } from '@tanstack/react-query'
+import { getSubmission, analyzeSolution, watchSubmission, watchAnalysisJob, type AnalysisRes } from '../api/clients'
 import { useEffect, useState } from 'react'
 
-type AnalysisRes = {
-  hints: string[];
-  probablePatterns?: string[];
-  complexityEstimate?: string;
-};
-
 export default function SubmissionPage() {
   const { id } = useParams()
   const nav = useNavigate()
+  const location = useLocation()
+  // Código enviado (llega desde ProblemDetailPage; no está si se recarga la página)
+  const navState = location.state as { source?: string; traceparent?: string } | null
+  const source = navState?.source ?? '// código del usuario'
+  const traceparent = navState?.traceparent
 
+  const queryClient = useQueryClient()
   const [analysis, setAnalysis] = useState<AnalysisRes | null>(null)
+  // Líneas de la IA que van llegando y su estado (el Analyzer responde antes)
+  const [aiLines, setAiLines] = useState<string[]>([])
+  const [aiStatus, setAiStatus] = useState<{ status: string; error?: string } | null>(null)
+  // Con el stream SSE activo no hace falta hacer polling; si se cae, se vuelve a él
+  const [streamFailed, setStreamFailed] = useState(false)
 
   // Obtener problemId de la URL
   const urlParams = new URLSearchParams(window.location.search);
@@ -25,10 +30,19 @@ export default function SubmissionPage() {
     enabled: !!id,
     refetchInterval: (q) => {
       const s = q.state.data as any
-      return !s || s.status !== 'done' ? 2000 : false
+      return streamFailed && (!s || s.status !== 'done') ? 2000 : false
     }
   })
 
+  useEffect(() => {
+    if (!id) return
+    return watchSubmission(
+      id,
+      (s) => queryClient.setQueryData(['submission', id], s),
+      () => setStreamFailed(true),
+    )
+  }, [id, queryClient])
+
   // Cuando el Evaluator termina (status === 'done'), disparamos el Analyzer (IA)
   useEffect(() => {
     async function run() {
@@ -38,17 +52,28 @@ export default function SubmissionPage() {
 
       try {
         const a = await analyzeSolution({
-          source: '// código del usuario',
+          source,
           results: sub,
           problemId: problemId
-        })
+        }, traceparent)
         setAnalysis(a)
       } catch (err) {
         console.error('Error llamando al Analyzer:', err)
       }
     }
     run()
-  }, [sub, analysis, problemId])
+  }, [sub, analysis, problemId, source, traceparent])
+
+  // Seguir el trabajo de la IA que dejó encolado el Analyzer
+  const jobId = analysis?.llm?.jobId
+  useEffect(() => {
+    if (!jobId) return
+    return watchAnalysisJob(
+      jobId,
+      (line) => setAiLines((prev) => [...prev, line]),
+      (status, error) => setAiStatus({ status, error }),
+    )
+  }, [jobId])
 
   if (isLoading || !sub) {
     return <p style={{ padding: 16 }}>Cargando…</p>
@@ -61,19 +86,36 @@ export default function SubmissionPage() {
       <div>
         <div>
           Estado: <b>{sub.status}</b>
+          {sub.status === 'queued' && typeof sub.queuePosition === 'number' && sub.queuePosition > 0
+            ? ` · posición en cola: ${sub.queuePosition}`
+            : ''}
+          {sub.status === 'running' && sub.progress
+            ? ` · caso ${sub.progress.done}/${sub.progress.total}`
+            : ''}
           {isFetching && sub.status !== 'done' ? ' (actualizando…)' : ''}
         </div>
 
         {sub.status === 'done' && (
           <div style={{ display: 'grid', gap: 8 }}>
-            <div>Tiempo total: {sub.timeMs} ms · Memoria: {sub.memoryKB} KB</div>
+            {sub.verdict && <div>Veredicto: <b>{sub.verdict}</b></div>}
+            <div>Tiempo CPU: {sub.timeMs} ms · Memoria: {sub.memoryKB} KB</div>
+            {sub.complexity?.class && (
+              <div>
+                Complejidad medida: <b>{sub.complexity.class}</b>
+                {sub.complexity.expected ? ` · esperada: ${sub.complexity.expected}` : ''}
+                {sub.complexity.meetsExpected === false ? ' ⚠️' : ''}
+                {` (${sub.complexity.points.length} tamaños, hasta n = ${sub.complexity.points[sub.complexity.points.length - 1].n})`}
+              </div>
+            )}
+            {sub.note && <pre style={{ whiteSpace: 'pre-wrap' }}>{sub.note}</pre>}
 
             <h3>Resultados por caso</h3>
             <ul>
               {sub.results?.map((r, i) => (
                 <li key={i}>
-                  Caso {typeof r.case === 'number' ? r.case : i + 1}: {r.pass ? '✔️ PASS' : '❌ FAIL'}
+                  Caso {typeof r.case === 'number' ? r.case : i + 1}: {r.skipped ? '⏭️ SKIP' : r.pass ? '✔️ PASS' : `❌ ${r.verdict ?? 'FAIL'}`}
                   {typeof r.timeMs === 'number' ? ` · ${r.timeMs} ms` : ''}
+                  {typeof r.memoryKB === 'number' ? ` · ${r.memoryKB} KB` : ''}
                   {r.stdout ? ` · out: ${r.stdout}` : ''}
                 </li>
               ))}
@@ -88,18 +130,37 @@ export default function SubmissionPage() {
         {/* Mientras NO tengamos análisis, mostramos siempre este mensaje */}
         {!analysis && (
           <p style={{ fontSize: 14, color: '#666' }}>
-            Preparando feedback del Coach (IA)…
+            Preparando feedback del Coach…
           </p>
         )}
 
-        {/* Cuando ya hay análisis, mostramos las pistas y la info extra */}
+        {/* Las pistas por reglas llegan al instante; las de la IA van apareciendo */}
         {analysis && (
           <>
+            {analysis.complexityEstimate && (
+              <div>Complejidad estimada: <b>{analysis.complexityEstimate}</b></div>
+            )}
             <ul>
               {analysis.hints.map((h, i) => (
                 <li key={i}>{h}</li>
               ))}
             </ul>
+
+            <h4>Sugerencia generada por IA:</h4>
+            <ul>
+              {aiLines.map((h, i) => (
+                <li key={i}>{h}</li>
+              ))}
+            </ul>
+            {analysis.llm?.status === 'unavailable' && (
+              <p style={{ fontSize: 14, color: '#666' }}>{analysis.llm.error}</p>
+            )}
+            {analysis.llm?.jobId && !aiStatus && (
+              <p style={{ fontSize: 14, color: '#666' }}>La IA está escribiendo…</p>
+            )}
+            {aiStatus?.status === 'error' && (
+              <p style={{ fontSize: 14, color: '#666' }}>{aiStatus.error}</p>
+            )}
           </>
         )}
       </div>
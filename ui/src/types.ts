@@ -17,12 +17,26 @@ export interface ExampleIO {
   out: any
 }
 
+// Firma tipada de Solution::<method> que usa el Evaluator para generar el harness
+export interface ProblemParam {
+  name: string
+  type: string                  // 'int', 'string', 'vector<int>', ...
+}
+
+export interface ProblemSignature {
+  method: string
+  returns: string               // 'void' => se imprime el parámetro `output`
+  params: ProblemParam[]
+  output?: string
+}
+
 // Problema completo que viene del Problem Manager (PM)
 export interface Problem extends ProblemSummary {
   statement: string
   examples: ExampleIO[]
   constraints?: Record<string, any>
   starterCode?: string          // código base para el editor
+  signature?: ProblemSignature  // firma para el harness del Evaluator
   tests: ExampleIO[]            // casos que luego usará el Evaluator
 }
 
@@ -34,27 +48,55 @@ export interface PostSubmissionReq {
   // por ahora solo C++ está soportado
   lang: 'cpp'
   source: string
+  stopOnFirstFailure?: boolean  // no ejecutar más casos tras el primer fallo
+  measureComplexity?: boolean   // tras un AC, medir la complejidad con entradas crecientes
 }
 
 export interface PostSubmissionRes {
   submissionId: string
 }
 
+// Veredicto de una ejecución (global o por caso)
+export type Verdict = 'AC' | 'WA' | 'CE' | 'RE' | 'TLE' | 'MLE' | 'OLE'
+
 // Resultado de cada caso de prueba que devuelve el Evaluator
 export interface EvalCaseResult {
   case: number          // 1, 2, ...
   pass: boolean
+  verdict?: Verdict
   stdout?: string
-  timeMs?: number
+  expected?: string
+  timeMs?: number       // CPU del caso
+  wallMs?: number
+  memoryKB?: number     // pico de RSS del caso
+  skipped?: boolean     // no se ejecutó (stopOnFirstFailure)
+}
+
+// Complejidad medida ejecutando la solución con entradas de tamaño creciente
+export interface EvalComplexity {
+  class?: string                // p. ej. "O(n log n)" (falta si hubo pocos puntos)
+  points: { n: number; ns: number; reps: number }[]
+  fit?: Record<string, number>  // error relativo de cada modelo
+  expected?: string             // clase esperada por el problema
+  meetsExpected?: boolean
+  stoppedAt?: { n: number; reason: string }
 }
 
 // Estado completo de una ejecución (/submissions/:id)
 export interface SubmissionStatus {
-  status: 'queued' | 'running' | 'done'
+  status: 'queued' | 'compiling' | 'running' | 'done'
+  version?: number       // aumenta con cada cambio (para long-poll: ?since=)
+  verdict?: Verdict
   results?: EvalCaseResult[]
-  timeMs?: number
-  memoryKB?: number
+  timeMs?: number        // tiempo de CPU (usuario + sistema)
+  wallMs?: number
+  userMs?: number
+  sysMs?: number
+  memoryKB?: number      // pico de memoria residente
+  queuePosition?: number // posición en la cola del Evaluator (solo si status === 'queued')
+  progress?: { done: number; total: number } // casos terminados (solo si status === 'running')
   note?: string          // mensajes de error, compilación, etc.
+  complexity?: EvalComplexity // solo si se pidió measureComplexity y hubo AC
 }
 
 // ======= Analyzer / LLM Coach =======
@@ -66,11 +108,20 @@ export interface AnalysisReq {
   problemId: string
 }
 
+// Trabajo de la IA que el Analyzer deja corriendo en segundo plano
+export interface AnalysisLlm {
+  jobId?: string       // no viene si la cola de la IA estaba llena
+  status: 'queued' | 'running' | 'done' | 'error' | 'unavailable'
+  cached?: boolean     // respuesta reutilizada de un análisis idéntico
+  error?: string
+}
+
 // Lo que devuelve el Analyzer
 export interface AnalysisRes {
   hints: string[]
   probablePatterns?: string[]
   complexityEstimate?: string
+  llm?: AnalysisLlm
 }
 
 export interface CreateProblemReq {
@@ -81,5 +132,6 @@ export interface CreateProblemReq {
   statement: string
   examples: ExampleIO[]
   starterCode?: string
+  signature?: ProblemSignature
   tests: ExampleIO[]
 }
\ No newline at end of file